@@ -0,0 +1,184 @@
+#pragma once
+#include "expandable_memory_resource.h"
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+class arena_memory_resource : public expandable_memory_resource {
+private:
+    static constexpr std::size_t min_alignment = alignof(std::max_align_t);
+    static constexpr std::size_t default_chunk_size = 4096;
+
+    // high_water is how far the chunk was used before the last time the
+    // arena left it or was reset. Blocks below it may predate a reset.
+    struct alignas(std::max_align_t) chunk_header {
+        chunk_header* next;
+        std::size_t size;
+        char* high_water;
+    };
+
+    static constexpr std::size_t chunk_header_size = sizeof(chunk_header);
+
+    std::pmr::memory_resource* upstream;
+    std::size_t first_chunk_size;
+    std::size_t next_chunk_size;
+    double growth_factor;
+    chunk_header* chunks = nullptr;
+    chunk_header* last_chunk = nullptr;
+    chunk_header* current = nullptr;
+    char* floor = nullptr;
+    char* cursor = nullptr;
+    char* end = nullptr;
+
+    static char* begin_of(chunk_header* chunk) { return reinterpret_cast<char*>(chunk) + chunk_header_size; }
+    static char* end_of(chunk_header* chunk) { return reinterpret_cast<char*>(chunk) + chunk->size; }
+
+    static char* align_up(char* p, std::size_t alignment) {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        std::uintptr_t aligned = (address + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        return p + (aligned - address);
+    }
+
+    static bool fits(char* from, char* to, std::size_t bytes, std::size_t alignment) {
+        if (!from) {
+            return false;
+        }
+        char* result = align_up(from, alignment);
+        return result <= to && static_cast<std::size_t>(to - result) >= bytes;
+    }
+
+    void use_chunk(chunk_header* chunk) {
+        current = chunk;
+        floor = chunk->high_water;
+        cursor = begin_of(chunk);
+        end = end_of(chunk);
+    }
+
+    void leave_chunk() {
+        if (current) {
+            current->high_water = std::max(current->high_water, cursor);
+        }
+    }
+
+    void next_fitting_chunk(std::size_t bytes, std::size_t alignment) {
+        leave_chunk();
+        for (chunk_header* chunk = current ? current->next : chunks; chunk; chunk = chunk->next) {
+            if (fits(begin_of(chunk), end_of(chunk), bytes, alignment)) {
+                use_chunk(chunk);
+                return;
+            }
+        }
+
+        std::size_t needed = chunk_header_size + bytes + (alignment > min_alignment ? alignment : 0);
+        std::size_t size = std::max(next_chunk_size, needed);
+        size = (size + min_alignment - 1) & ~(min_alignment - 1);
+
+        chunk_header* chunk = static_cast<chunk_header*>(upstream->allocate(size, min_alignment));
+        chunk->next = nullptr;
+        chunk->size = size;
+        chunk->high_water = begin_of(chunk);
+        if (last_chunk) {
+            last_chunk->next = chunk;
+        } else {
+            chunks = chunk;
+        }
+        last_chunk = chunk;
+
+        double grown = static_cast<double>(next_chunk_size) * growth_factor;
+        if (grown < static_cast<double>(std::size_t(-1) / 2)) {
+            next_chunk_size = std::max(next_chunk_size, static_cast<std::size_t>(grown));
+        }
+
+        use_chunk(chunk);
+    }
+
+public:
+    arena_memory_resource() : arena_memory_resource(std::pmr::get_default_resource()) {}
+
+    explicit arena_memory_resource(std::pmr::memory_resource* upstream_mr,
+                                   std::size_t initial_chunk_size = default_chunk_size,
+                                   double chunk_growth_factor = 2.0)
+        : upstream(upstream_mr),
+          first_chunk_size(std::max(initial_chunk_size, chunk_header_size + min_alignment)),
+          next_chunk_size(first_chunk_size),
+          growth_factor(chunk_growth_factor < 1.0 ? 1.0 : chunk_growth_factor) {}
+
+    arena_memory_resource(const arena_memory_resource&) = delete;
+    arena_memory_resource& operator=(const arena_memory_resource&) = delete;
+
+    ~arena_memory_resource() override {
+        release();
+    }
+
+    // Forgets every allocation but keeps the chunks for the next round.
+    // Blocks from before the reset may still be deallocated afterwards:
+    // deallocate only rewinds over memory past each chunk's high-water mark,
+    // so such a late free cannot give back memory handed out since.
+    void reset() {
+        leave_chunk();
+        current = nullptr;
+        floor = nullptr;
+        cursor = nullptr;
+        end = nullptr;
+        if (chunks) {
+            use_chunk(chunks);
+        }
+    }
+
+    // Forgets every allocation and returns all chunks to upstream.
+    void release() {
+        while (chunks) {
+            chunk_header* next = chunks->next;
+            upstream->deallocate(chunks, chunks->size, min_alignment);
+            chunks = next;
+        }
+        last_chunk = nullptr;
+        current = nullptr;
+        floor = nullptr;
+        cursor = nullptr;
+        end = nullptr;
+        next_chunk_size = first_chunk_size;
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream; }
+
+    std::size_t chunk_count() const {
+        std::size_t count = 0;
+        for (chunk_header* chunk = chunks; chunk; chunk = chunk->next) {
+            ++count;
+        }
+        return count;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!fits(cursor, end, bytes, alignment)) {
+            next_fitting_chunk(bytes, alignment);
+        }
+        char* result = align_up(cursor, alignment);
+        cursor = result + bytes;
+        return result;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t) override {
+        char* block = static_cast<char*>(p);
+        if (block >= floor && block + bytes == cursor) {
+            cursor = block;
+        }
+    }
+
+    bool do_try_expand(void* p, std::size_t old_bytes, std::size_t new_bytes) override {
+        char* block = static_cast<char*>(p);
+        if (block + old_bytes != cursor || static_cast<std::size_t>(end - block) < new_bytes) {
+            return false;
+        }
+        cursor = block + new_bytes;
+        return true;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
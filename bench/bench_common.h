@@ -0,0 +1,128 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace bench {
+
+using clock = std::chrono::steady_clock;
+
+inline std::int64_t elapsed_ns(clock::time_point start, clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+inline std::int64_t percentile(std::vector<std::int64_t> samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::size_t index = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+inline double mean(const std::vector<std::int64_t>& samples) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (std::int64_t s : samples) {
+        sum += static_cast<double>(s);
+    }
+    return sum / static_cast<double>(samples.size());
+}
+
+template<typename T>
+inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+// Forwards every call unchanged. Useful as a stand-in for upstream itself
+// and to hide extensions such as try_expand() from containers.
+class forwarding_resource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+
+public:
+    explicit forwarding_resource(std::pmr::memory_resource* mr) : upstream(mr) {}
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+class locked_resource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+    std::mutex mutex;
+
+public:
+    explicit locked_resource(std::pmr::memory_resource* mr) : upstream(mr) {}
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+class counting_resource : public std::pmr::memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+    std::size_t current = 0;
+    std::size_t peak = 0;
+    std::size_t calls = 0;
+
+public:
+    explicit counting_resource(std::pmr::memory_resource* mr = std::pmr::get_default_resource()) : upstream(mr) {}
+
+    std::size_t bytes_in_use() const { return current; }
+    std::size_t peak_bytes() const { return peak; }
+    std::size_t allocation_calls() const { return calls; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* p = upstream->allocate(bytes, alignment);
+        current += bytes;
+        peak = std::max(peak, current);
+        ++calls;
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        upstream->deallocate(p, bytes, alignment);
+        current -= bytes;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+}
@@ -0,0 +1,70 @@
+#include "dynamic_array.h"
+#include "buddy_memory_resource.h"
+#include "tlsf_memory_resource.h"
+#include "bench_common.h"
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// One large array grown by push_back, rebuilt several times.
+void doubling(std::pmr::memory_resource* mr) {
+    for (int round = 0; round < 20; ++round) {
+        dynamic_array<int> arr(mr);
+        for (int i = 0; i < (1 << 18); ++i) {
+            arr.push_back(i);
+        }
+        bench::do_not_optimize(arr.back());
+    }
+}
+
+// Many arrays of log-uniform target sizes grown and torn down in random order.
+void many_arrays(std::pmr::memory_resource* mr) {
+    constexpr std::size_t slots = 256;
+    std::vector<std::unique_ptr<dynamic_array<int>>> arrays(slots);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> log_size(0.0, 14.0);
+    for (std::size_t step = 0; step < 50000; ++step) {
+        auto& arr = arrays[rng() % slots];
+        if (arr) {
+            arr.reset();
+            continue;
+        }
+        arr = std::make_unique<dynamic_array<int>>(mr);
+        std::size_t target = static_cast<std::size_t>(std::exp2(log_size(rng)));
+        for (std::size_t i = 0; i < target; ++i) {
+            arr->push_back(static_cast<int>(i));
+        }
+    }
+}
+
+template<typename Resource, typename Workload>
+void run(const char* name, const char* workload_name, Workload workload) {
+    bench::counting_resource upstream;
+    auto start = bench::clock::now();
+    {
+        Resource mr(&upstream);
+        workload(&mr);
+    }
+    auto end = bench::clock::now();
+
+    std::cout << name << "\tworkload=" << workload_name
+              << "\tms=" << static_cast<double>(bench::elapsed_ns(start, end)) / 1e6
+              << "\tpeak_upstream_bytes=" << upstream.peak_bytes()
+              << "\tupstream_calls=" << upstream.allocation_calls() << std::endl;
+}
+
+template<typename Workload>
+void run_all(const char* workload_name, Workload workload) {
+    run<dynamic_list_memory_resource>("dynamic_list", workload_name, workload);
+    run<basic_dynamic_list_memory_resource<best_fit_policy>>("dynamic_list_best_fit", workload_name, workload);
+    run<tlsf_memory_resource>("tlsf", workload_name, workload);
+    run<buddy_memory_resource>("buddy", workload_name, workload);
+}
+
+int main() {
+    run_all("doubling", doubling);
+    run_all("many_arrays", many_arrays);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "dynamic_array.h"
+#include "arena_memory_resource.h"
+#include "tlsf_memory_resource.h"
+#include "bench_common.h"
+#include <iostream>
+#include <string>
+
+struct payload {
+    std::string label;
+    double weights[4];
+};
+
+template<typename T>
+void grow(std::pmr::memory_resource* mr, std::size_t count) {
+    for (int round = 0; round < 5; ++round) {
+        dynamic_array<T> arr(mr);
+        for (std::size_t i = 0; i < count; ++i) {
+            arr.push_back(T{});
+        }
+        bench::do_not_optimize(arr.back());
+    }
+}
+
+// Grows large arrays with push_back through each expandable engine, once
+// directly and once behind a plain forwarding resource that hides
+// try_expand(), so every growth step has to relocate. Each engine starts
+// with a 256 MiB chunk so the arrays have room to grow in place.
+template<typename Resource>
+void run(const char* name) {
+    for (bool expandable : {true, false}) {
+        bench::counting_resource upstream;
+        auto start = bench::clock::now();
+        {
+            Resource engine(&upstream, std::size_t(256) << 20);
+            bench::forwarding_resource opaque(&engine);
+            std::pmr::memory_resource* mr = expandable ? static_cast<std::pmr::memory_resource*>(&engine) : &opaque;
+            grow<int>(mr, std::size_t(1) << 22);
+            grow<payload>(mr, std::size_t(1) << 18);
+        }
+        auto end = bench::clock::now();
+
+        std::cout << name << "\ttry_expand=" << (expandable ? "yes" : "no")
+                  << "\tms=" << static_cast<double>(bench::elapsed_ns(start, end)) / 1e6
+                  << "\tpeak_upstream_bytes=" << upstream.peak_bytes() << std::endl;
+    }
+}
+
+int main() {
+    run<dynamic_list_memory_resource>("dynamic_list");
+    run<tlsf_memory_resource>("tlsf");
+    run<arena_memory_resource>("arena");
+    return 0;
+}
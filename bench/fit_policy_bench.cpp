@@ -0,0 +1,59 @@
+#include "dynamic_array.h"
+#include "bench_common.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Replays the same dynamic_array growth trace against each fit policy: a
+// fixed set of slots is repeatedly filled with arrays grown by push_back
+// to a log-uniform target size and torn down again.
+template<typename Policy>
+void run(const char* name) {
+    constexpr std::size_t slots = 256;
+    constexpr std::size_t steps = 200000;
+
+    basic_dynamic_list_memory_resource<Policy> mr;
+    std::vector<std::unique_ptr<dynamic_array<int>>> arrays(slots);
+    std::vector<std::size_t> targets(slots, 0);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> log_size(0.0, 14.0);
+
+    auto start = bench::clock::now();
+    for (std::size_t step = 0; step < steps; ++step) {
+        std::size_t slot = rng() % slots;
+        auto& arr = arrays[slot];
+        if (!arr) {
+            arr = std::make_unique<dynamic_array<int>>(&mr);
+            targets[slot] = static_cast<std::size_t>(std::exp2(log_size(rng)));
+        } else if (arr->size() >= targets[slot]) {
+            arr.reset();
+            continue;
+        }
+        std::size_t burst = std::min<std::size_t>(targets[slot] - arr->size(), 64);
+        for (std::size_t i = 0; i < burst; ++i) {
+            arr->push_back(static_cast<int>(i));
+        }
+    }
+    auto end = bench::clock::now();
+
+    memory_resource_stats stats = mr.stats();
+    double seconds = static_cast<double>(bench::elapsed_ns(start, end)) / 1e9;
+    std::cout << name
+              << "\tsteps_per_s=" << static_cast<double>(steps) / seconds
+              << "\tpeak_live_bytes=" << stats.bytes_high_water
+              << "\tupstream_bytes=" << stats.upstream_bytes
+              << "\tavg_search_steps=" << stats.average_search_steps()
+              << "\tfragmentation=" << stats.fragmentation << std::endl;
+
+    arrays.clear();
+}
+
+int main() {
+    run<first_fit_policy>("first_fit");
+    run<next_fit_policy>("next_fit");
+    run<best_fit_policy>("best_fit");
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "dynamic_array.h"
+#include "buddy_memory_resource.h"
+#include "expandable_memory_resource.h"
+#include "bench_common.h"
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Sits between the arrays and the resource under test and records how
+// many bytes were given back during growth, i.e. old buffers whose
+// contents had to be moved. try_expand() and good_size() are forwarded
+// so the arrays see the resource's real capabilities.
+class growth_probe_resource : public expandable_memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+    std::size_t freed = 0;
+    std::size_t relocations = 0;
+    std::size_t expansions = 0;
+
+public:
+    explicit growth_probe_resource(std::pmr::memory_resource* mr) : upstream(mr) {}
+
+    std::size_t freed_bytes() const { return freed; }
+    std::size_t relocation_count() const { return relocations; }
+    std::size_t expansion_count() const { return expansions; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        freed += bytes;
+        ++relocations;
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_try_expand(void* p, std::size_t old_bytes, std::size_t new_bytes) override {
+        bool expanded = ::try_expand(upstream, p, old_bytes, new_bytes);
+        expansions += expanded ? 1 : 0;
+        return expanded;
+    }
+
+    std::size_t do_good_size(std::size_t bytes, std::size_t alignment) const override {
+        return ::good_size(upstream, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Grows `array_count` int arrays round-robin to `elements` each, so with
+// more than one array the growth steps of different arrays interleave.
+template<typename Resource, typename Policy>
+void run(const char* resource_name, const char* policy_name, std::size_t array_count, std::size_t elements) {
+    bench::counting_resource upstream;
+    std::size_t relocation_bytes = 0;
+    std::size_t relocations = 0;
+    std::size_t expansions = 0;
+    std::size_t capacity = 0;
+    auto start = bench::clock::now();
+    {
+        Resource engine(&upstream);
+        growth_probe_resource probe(&engine);
+        std::vector<std::unique_ptr<dynamic_array<int, Policy>>> arrays;
+        for (std::size_t a = 0; a < array_count; ++a) {
+            arrays.push_back(std::make_unique<dynamic_array<int, Policy>>(&probe));
+        }
+        for (std::size_t i = 0; i < elements; ++i) {
+            for (auto& arr : arrays) {
+                arr->push_back(static_cast<int>(i));
+            }
+        }
+        relocation_bytes = probe.freed_bytes();
+        relocations = probe.relocation_count();
+        expansions = probe.expansion_count();
+        for (auto& arr : arrays) {
+            capacity += arr->capacity();
+        }
+    }
+    auto end = bench::clock::now();
+
+    std::size_t used = array_count * elements;
+    std::cout << resource_name << "\tpolicy=" << policy_name << "\tarrays=" << array_count
+              << "\tms=" << static_cast<double>(bench::elapsed_ns(start, end)) / 1e6
+              << "\tpeak_upstream_bytes=" << upstream.peak_bytes()
+              << "\trelocation_bytes=" << relocation_bytes
+              << "\trelocations=" << relocations
+              << "\tin_place_expansions=" << expansions
+              << "\tslack_percent=" << 100.0 * static_cast<double>(capacity - used) / static_cast<double>(capacity)
+              << std::endl;
+}
+
+template<typename Resource>
+void run_policies(const char* resource_name, std::size_t array_count, std::size_t elements) {
+    run<Resource, doubling_growth>(resource_name, "2x", array_count, elements);
+    run<Resource, one_and_half_growth>(resource_name, "1.5x", array_count, elements);
+    run<Resource, fixed_increment_growth<16384>>(resource_name, "fixed_16384", array_count, elements);
+    run<Resource, page_rounded_growth<>>(resource_name, "2x_page_rounded", array_count, elements);
+    run<Resource, page_rounded_growth<one_and_half_growth>>(resource_name, "1.5x_page_rounded", array_count, elements);
+}
+
+// An int that dynamic_array cannot relocate with memcpy, for comparison.
+struct copied_int {
+    int value = 0;
+
+    copied_int() = default;
+    copied_int(const copied_int& other) : value(other.value) {}
+};
+
+// Relocation throughput: a `bytes`-sized dynamic_array<T> is moved to a new
+// buffer by reserve(). Both buffers come from a monotonic resource over
+// memory touched up front, which has no try_expand(), so only the copy is
+// timed and not page faults. Small sizes stay in cache; large ones show
+// memory bandwidth.
+template<typename T>
+void run_relocation(const char* element_name, std::size_t bytes) {
+    std::vector<char> backing(2 * bytes + 4096, 1);
+    std::size_t count = bytes / sizeof(T);
+    std::size_t rounds = std::max<std::size_t>((std::size_t(1) << 30) / bytes, 16);
+    std::int64_t ns = 0;
+    for (std::size_t round = 0; round < rounds; ++round) {
+        std::pmr::monotonic_buffer_resource mr(backing.data(), backing.size(), std::pmr::null_memory_resource());
+        dynamic_array<T> arr(&mr);
+        arr.resize(count);
+        auto start = bench::clock::now();
+        arr.reserve(count + 1);
+        ns += bench::elapsed_ns(start, bench::clock::now());
+        bench::do_not_optimize(arr.back());
+    }
+
+    double moved = static_cast<double>(rounds) * static_cast<double>(count * sizeof(T));
+    std::cout << "relocation\telement=" << element_name << "\tbytes=" << count * sizeof(T)
+              << "\trounds=" << rounds
+              << "\tgb_per_s=" << (ns > 0 ? moved / static_cast<double>(ns) : 0.0) << std::endl;
+}
+
+template<typename Resource>
+void run_all(const char* resource_name) {
+    run_policies<Resource>(resource_name, 1, std::size_t(1) << 20);
+    run_policies<Resource>(resource_name, 8, std::size_t(1) << 17);
+}
+
+int main() {
+    run_all<bench::forwarding_resource>("new_delete");
+    run_all<dynamic_list_memory_resource>("dynamic_list");
+    run_all<buddy_memory_resource>("buddy");
+    for (std::size_t bytes : {std::size_t(32) << 10, std::size_t(64) << 20}) {
+        run_relocation<int>("int", bytes);
+        run_relocation<copied_int>("copied_int", bytes);
+    }
+    return 0;
+}
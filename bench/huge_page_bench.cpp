@@ -0,0 +1,47 @@
+#include "dynamic_array.h"
+#include "huge_page_memory_resource.h"
+#include "bench_common.h"
+#include <cstdint>
+#include <iostream>
+
+// Sequential and random scans over a large dynamic_array<double>. The random
+// pass walks a full-period LCG over the indices so nearly every access
+// lands on a different page.
+void run(const char* name, std::pmr::memory_resource* mr) {
+    constexpr std::size_t count = std::size_t(1) << 24;
+    constexpr std::size_t random_reads = std::size_t(1) << 24;
+
+    dynamic_array<double> arr(count, mr);
+    for (std::size_t i = 0; i < count; ++i) {
+        arr[i] = static_cast<double>(i);
+    }
+
+    auto start = bench::clock::now();
+    double sum = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        sum += arr[i];
+    }
+    auto middle = bench::clock::now();
+    std::uint64_t index = 1;
+    for (std::size_t i = 0; i < random_reads; ++i) {
+        index = (index * 6364136223846793005ULL + 1442695040888963407ULL) & (count - 1);
+        sum += arr[static_cast<std::size_t>(index)];
+    }
+    auto end = bench::clock::now();
+    bench::do_not_optimize(sum);
+
+    std::cout << name
+              << "\tsequential_ns_per_read=" << static_cast<double>(bench::elapsed_ns(start, middle)) / count
+              << "\trandom_ns_per_read=" << static_cast<double>(bench::elapsed_ns(middle, end)) / random_reads
+              << std::endl;
+}
+
+int main() {
+    run("new_delete", std::pmr::new_delete_resource());
+
+    huge_page_memory_resource huge;
+    run("huge_page", &huge);
+    std::cout << "hugetlb_mappings=" << huge.hugetlb_mappings()
+              << "\ttransparent_mappings=" << huge.transparent_mappings() << std::endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "dynamic_array.h"
+#include "lock_free_pool_resource.h"
+#include "thread_caching_memory_resource.h"
+#include "bench_common.h"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Person {
+    std::string name;
+    int age;
+    double salary;
+
+    Person() : name(""), age(0), salary(0.0) {}
+    Person(const std::string& n, int a, double s) : name(n), age(a), salary(s) {}
+};
+
+// Many threads briefly creating tiny arrays: one 4-element allocation for
+// the ints and one for a couple of Person records per iteration.
+void worker(std::pmr::memory_resource* mr, std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+        dynamic_array<int> ints(mr);
+        ints.push_back(static_cast<int>(i));
+        ints.push_back(1);
+
+        dynamic_array<Person> people(mr);
+        people.emplace_back("a", 1, 1.0);
+        people.emplace_back("b", 2, 2.0);
+
+        bench::do_not_optimize(ints.back());
+        bench::do_not_optimize(people.back().age);
+    }
+}
+
+void run(const char* name, std::pmr::memory_resource* mr, std::size_t threads) {
+    constexpr std::size_t iterations = 200000;
+
+    auto start = bench::clock::now();
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back(worker, mr, iterations);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    auto end = bench::clock::now();
+
+    double seconds = static_cast<double>(bench::elapsed_ns(start, end)) / 1e9;
+    double ops_per_second = static_cast<double>(threads * iterations * 2) / seconds;
+    std::cout << name << "\tthreads=" << threads << "\tallocs_per_s=" << ops_per_second << std::endl;
+}
+
+int main() {
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        {
+            dynamic_list_memory_resource list;
+            bench::locked_resource locked(&list);
+            run("locked_dynamic_list", &locked, threads);
+        }
+        {
+            std::pmr::synchronized_pool_resource pool;
+            run("synchronized_pool", &pool, threads);
+        }
+        {
+            thread_caching_memory_resource caching;
+            run("thread_caching", &caching, threads);
+        }
+        {
+            lock_free_pool_resource lock_free;
+            run("lock_free_pool", &lock_free, threads);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "mapped_file_memory_resource.h"
+#include "bench_common.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// Compares rebuilding a table on every start with reopening a checkpointed
+// mapped file. The sum over the table touches every page in both cases.
+int main() {
+    constexpr int count = 10000000;
+    const std::string path = "mapped_file_bench.bin";
+    std::remove(path.c_str());
+
+    auto build_start = bench::clock::now();
+    long long rebuilt_sum = 0;
+    {
+        dynamic_array<int> table;
+        for (int i = 0; i < count; ++i) {
+            table.push_back(i);
+        }
+        for (int value : table) {
+            rebuilt_sum += value;
+        }
+    }
+    auto build_end = bench::clock::now();
+
+    {
+        mapped_file_memory_resource mr(path);
+        dynamic_array<int> table(&mr);
+        for (int i = 0; i < count; ++i) {
+            table.push_back(i);
+        }
+        mr.checkpoint(table);
+    }
+
+    auto load_start = bench::clock::now();
+    long long loaded_sum = 0;
+    std::size_t loaded_size = 0;
+    {
+        mapped_file_memory_resource mr(path);
+        dynamic_array<int> table = mr.load_root<int>();
+        loaded_size = table.size();
+        for (int value : table) {
+            loaded_sum += value;
+        }
+    }
+    auto load_end = bench::clock::now();
+    std::remove(path.c_str());
+
+    std::cout << "rebuild_ms=" << static_cast<double>(bench::elapsed_ns(build_start, build_end)) / 1e6
+              << "\treload_ms=" << static_cast<double>(bench::elapsed_ns(load_start, load_end)) / 1e6
+              << "\telements=" << loaded_size
+              << "\tsums_match=" << (rebuilt_sum == loaded_sum ? "yes" : "no") << std::endl;
+    return 0;
+}
@@ -0,0 +1,393 @@
+#include "dynamic_array.h"
+#include "expandable_memory_resource.h"
+#include "bench_common.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define MEMORY_RESOURCE_BENCH_POSIX 1
+#endif
+
+// Standard workloads run against each resource. Every (workload, resource)
+// pair prints one JSON object per line with throughput, per-call latency
+// percentiles, peak upstream footprint and peak RSS. On POSIX each pair
+// runs in its own child processes so peak RSS belongs to that pair alone;
+// elsewhere peak_rss_bytes is null. A pair whose process fails prints a
+// row with an "error" field instead of its numbers.
+//
+// Each pair runs twice, in separate processes: once counting calls for
+// ops/s and peak RSS, once timing every call for the percentiles, so
+// neither clock reads nor the latency samples distort the other figures.
+// The raw workloads write every block they get so untouched pages do not
+// hide a resource's real footprint from peak RSS.
+
+// Forwards to the resource under test, counting calls and optionally timing
+// each one. try_expand() and good_size() are forwarded too, so containers
+// see the same capabilities as they would without the wrapper.
+class instrumented_resource : public expandable_memory_resource {
+private:
+    std::pmr::memory_resource* upstream;
+    std::vector<std::int64_t>* samples;
+    std::size_t calls = 0;
+
+    template<typename F>
+    auto measure(F&& f) {
+        ++calls;
+        if (!samples) {
+            return f();
+        }
+        auto start = bench::clock::now();
+        auto result = f();
+        samples->push_back(bench::elapsed_ns(start, bench::clock::now()));
+        return result;
+    }
+
+public:
+    instrumented_resource(std::pmr::memory_resource* mr, std::vector<std::int64_t>* latency_samples)
+        : upstream(mr), samples(latency_samples) {}
+
+    std::size_t call_count() const { return calls; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return measure([&] { return upstream->allocate(bytes, alignment); });
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        measure([&] {
+            upstream->deallocate(p, bytes, alignment);
+            return true;
+        });
+    }
+
+    bool do_try_expand(void* p, std::size_t old_bytes, std::size_t new_bytes) override {
+        return measure([&] { return ::try_expand(upstream, p, old_bytes, new_bytes); });
+    }
+
+    std::size_t do_good_size(std::size_t bytes, std::size_t alignment) const override {
+        return ::good_size(upstream, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Arrays grown one element at a time to a large size.
+void grow_large_arrays(std::pmr::memory_resource* mr) {
+    for (int round = 0; round < 10; ++round) {
+        dynamic_array<int> arr(mr);
+        for (int i = 0; i < (1 << 18); ++i) {
+            arr.push_back(i);
+        }
+        bench::do_not_optimize(arr.back());
+    }
+}
+
+// Random allocate/free with log-uniform sizes from 8 bytes to 8 KiB.
+void random_churn(std::pmr::memory_resource* mr) {
+    struct block {
+        void* p;
+        std::size_t size;
+    };
+    constexpr std::size_t slots = 1024;
+    std::vector<block> live(slots, block{nullptr, 0});
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> log_size(3.0, 13.0);
+    for (std::size_t step = 0; step < 200000; ++step) {
+        block& b = live[rng() % slots];
+        if (b.p) {
+            mr->deallocate(b.p, b.size);
+            b.p = nullptr;
+        } else {
+            b.size = static_cast<std::size_t>(std::exp2(log_size(rng)));
+            b.p = mr->allocate(b.size);
+            std::memset(b.p, 1, b.size);
+        }
+    }
+    for (block& b : live) {
+        if (b.p) {
+            mr->deallocate(b.p, b.size);
+        }
+    }
+}
+
+// Messages freed in arrival order, as a consumer draining a producer's
+// queue would, rather than in the LIFO order most allocators favour.
+void producer_consumer(std::pmr::memory_resource* mr) {
+    struct message {
+        void* p;
+        std::size_t size;
+    };
+    constexpr std::size_t queue_depth = 1024;
+    std::vector<message> queue(queue_depth, message{nullptr, 0});
+    std::mt19937 rng(22);
+    std::size_t head = 0;
+    for (std::size_t step = 0; step < 200000; ++step) {
+        message& m = queue[head];
+        if (m.p) {
+            mr->deallocate(m.p, m.size);
+        }
+        m.size = 64 + rng() % 961;
+        m.p = mr->allocate(m.size);
+        std::memset(m.p, 1, m.size);
+        head = (head + 1) % queue_depth;
+    }
+    for (message& m : queue) {
+        if (m.p) {
+            mr->deallocate(m.p, m.size);
+        }
+    }
+}
+
+// Thousands of short-lived arrays holding a handful of elements.
+void many_small_arrays(std::pmr::memory_resource* mr) {
+    constexpr std::size_t slots = 4096;
+    std::vector<std::unique_ptr<dynamic_array<int>>> arrays(slots);
+    std::mt19937 rng(23);
+    for (std::size_t step = 0; step < 200000; ++step) {
+        auto& arr = arrays[rng() % slots];
+        if (arr) {
+            arr.reset();
+            continue;
+        }
+        arr = std::make_unique<dynamic_array<int>>(mr);
+        std::size_t count = 1 + rng() % 16;
+        for (std::size_t i = 0; i < count; ++i) {
+            arr->push_back(static_cast<int>(i));
+        }
+    }
+}
+
+// Small and medium blocks interleaved, the medium ones freed to leave
+// holes, then requests slightly larger than every hole.
+void adversarial_fragmentation(std::pmr::memory_resource* mr) {
+    constexpr std::size_t pairs = 20000;
+    std::vector<void*> small(pairs);
+    std::vector<void*> medium(pairs);
+    std::vector<void*> large(pairs);
+    for (int round = 0; round < 5; ++round) {
+        for (std::size_t i = 0; i < pairs; ++i) {
+            small[i] = mr->allocate(48);
+            medium[i] = mr->allocate(256);
+            std::memset(small[i], 1, 48);
+            std::memset(medium[i], 1, 256);
+        }
+        for (std::size_t i = 0; i < pairs; ++i) {
+            mr->deallocate(medium[i], 256);
+        }
+        for (std::size_t i = 0; i < pairs; ++i) {
+            large[i] = mr->allocate(272);
+            std::memset(large[i], 1, 272);
+        }
+        for (std::size_t i = 0; i < pairs; ++i) {
+            mr->deallocate(small[i], 48);
+            mr->deallocate(large[i], 272);
+        }
+    }
+}
+
+using workload_fn = void (*)(std::pmr::memory_resource*);
+using resource_factory = std::function<std::unique_ptr<std::pmr::memory_resource>(std::pmr::memory_resource*)>;
+
+struct run_result {
+    std::size_t ops = 0;
+    std::int64_t ns = 0;
+    std::vector<std::int64_t> samples;
+    std::size_t peak_upstream_bytes = 0;
+};
+
+run_result run_once(workload_fn workload, const resource_factory& make, bool timed) {
+    run_result result;
+    bench::counting_resource upstream;
+    if (timed) {
+        result.samples.reserve(1 << 20);
+    }
+    auto start = bench::clock::now();
+    {
+        std::unique_ptr<std::pmr::memory_resource> engine = make(&upstream);
+        instrumented_resource mr(engine.get(), timed ? &result.samples : nullptr);
+        workload(&mr);
+        result.ops = mr.call_count();
+    }
+    result.ns = bench::elapsed_ns(start, bench::clock::now());
+    result.peak_upstream_bytes = upstream.peak_bytes();
+    return result;
+}
+
+long long peak_rss_bytes() {
+#ifdef MEMORY_RESOURCE_BENCH_POSIX
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<long long>(usage.ru_maxrss);
+#else
+    return static_cast<long long>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return -1;
+#endif
+}
+
+// Result of the untimed pass, whose process peak RSS is the footprint.
+struct throughput_result {
+    std::size_t ops;
+    std::int64_t ns;
+    std::size_t peak_upstream_bytes;
+    long long peak_rss_bytes;
+};
+
+struct latency_result {
+    double mean;
+    std::int64_t p50;
+    std::int64_t p90;
+    std::int64_t p99;
+    std::int64_t p999;
+};
+
+throughput_result measure_throughput(workload_fn workload, const resource_factory& make) {
+    run_result plain = run_once(workload, make, false);
+    return throughput_result{plain.ops, plain.ns, plain.peak_upstream_bytes, peak_rss_bytes()};
+}
+
+latency_result measure_latency(workload_fn workload, const resource_factory& make) {
+    run_result timed = run_once(workload, make, true);
+    return latency_result{bench::mean(timed.samples), bench::percentile(timed.samples, 0.50),
+                          bench::percentile(timed.samples, 0.90), bench::percentile(timed.samples, 0.99),
+                          bench::percentile(timed.samples, 0.999)};
+}
+
+// Runs `f` in a child process on POSIX and hands its result back through a
+// pipe. Returns false when the child crashed, exited non-zero or sent a
+// short result.
+template<typename Result, typename F>
+bool run_isolated(F f, Result& result) {
+#ifdef MEMORY_RESOURCE_BENCH_POSIX
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        Result r = f();
+        const char* bytes = reinterpret_cast<const char*>(&r);
+        std::size_t written = 0;
+        while (written < sizeof(r)) {
+            ssize_t n = write(fds[1], bytes + written, sizeof(r) - written);
+            if (n <= 0) {
+                _exit(1);
+            }
+            written += static_cast<std::size_t>(n);
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    char* bytes = reinterpret_cast<char*>(&result);
+    std::size_t received = 0;
+    while (received < sizeof(result)) {
+        ssize_t n = read(fds[0], bytes + received, sizeof(result) - received);
+        if (n <= 0) {
+            break;
+        }
+        received += static_cast<std::size_t>(n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 && received == sizeof(result);
+#else
+    result = f();
+    return true;
+#endif
+}
+
+void run_case(const char* workload_name, workload_fn workload, const char* resource_name,
+              const resource_factory& make) {
+    throughput_result plain{};
+    latency_result timed{};
+    bool ok = run_isolated([&] { return measure_throughput(workload, make); }, plain) &&
+              run_isolated([&] { return measure_latency(workload, make); }, timed);
+
+    std::cout << "{\"workload\":\"" << workload_name << "\""
+              << ",\"resource\":\"" << resource_name << "\"";
+    if (!ok) {
+        std::cout << ",\"error\":\"benchmark process failed\"}" << std::endl;
+        return;
+    }
+
+    double seconds = static_cast<double>(plain.ns) / 1e9;
+    std::cout << ",\"ops\":" << plain.ops
+              << ",\"seconds\":" << seconds
+              << ",\"ops_per_s\":" << (seconds > 0 ? static_cast<double>(plain.ops) / seconds : 0.0)
+              << ",\"ns_per_op_mean\":" << timed.mean
+              << ",\"ns_per_op_p50\":" << timed.p50
+              << ",\"ns_per_op_p90\":" << timed.p90
+              << ",\"ns_per_op_p99\":" << timed.p99
+              << ",\"ns_per_op_p999\":" << timed.p999
+              << ",\"peak_upstream_bytes\":" << plain.peak_upstream_bytes
+              << ",\"peak_rss_bytes\":";
+    if (plain.peak_rss_bytes < 0) {
+        std::cout << "null";
+    } else {
+        std::cout << plain.peak_rss_bytes;
+    }
+    std::cout << "}" << std::endl;
+}
+
+int main() {
+    struct named_workload {
+        const char* name;
+        workload_fn fn;
+    };
+    const named_workload workloads[] = {
+        {"doubling_growth", grow_large_arrays},
+        {"random_churn", random_churn},
+        {"producer_consumer", producer_consumer},
+        {"many_small_arrays", many_small_arrays},
+        {"adversarial_fragmentation", adversarial_fragmentation},
+    };
+
+    struct named_resource {
+        const char* name;
+        resource_factory make;
+    };
+    const named_resource resources[] = {
+        {"dynamic_list", [](std::pmr::memory_resource* up) -> std::unique_ptr<std::pmr::memory_resource> {
+             return std::make_unique<dynamic_list_memory_resource>(up);
+         }},
+        {"new_delete", [](std::pmr::memory_resource* up) -> std::unique_ptr<std::pmr::memory_resource> {
+             return std::make_unique<bench::forwarding_resource>(up);
+         }},
+        {"unsynchronized_pool", [](std::pmr::memory_resource* up) -> std::unique_ptr<std::pmr::memory_resource> {
+             return std::make_unique<std::pmr::unsynchronized_pool_resource>(up);
+         }},
+        {"monotonic", [](std::pmr::memory_resource* up) -> std::unique_ptr<std::pmr::memory_resource> {
+             return std::make_unique<std::pmr::monotonic_buffer_resource>(up);
+         }},
+    };
+
+    for (const named_workload& w : workloads) {
+        for (const named_resource& r : resources) {
+            run_case(w.name, w.fn, r.name, r.make);
+        }
+    }
+    return 0;
+}
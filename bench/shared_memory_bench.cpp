@@ -0,0 +1,169 @@
+#include "shared_memory_resource.h"
+#include "bench_common.h"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// One producer appends records while several reader processes consume them,
+// first by copying everything over one pipe per reader, then by reading the
+// same shared memory segment in place. Readers exit non-zero if their
+// checksum does not match.
+struct record {
+    std::uint64_t id;
+    double value;
+};
+
+constexpr std::size_t record_count = 2000000;
+constexpr int reader_count = 3;
+const char* const segment_name = "/dynamic_array_shared_memory_bench";
+
+std::uint64_t expected_sum() {
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < record_count; ++i) {
+        sum += i;
+    }
+    return sum;
+}
+
+bool wait_for_readers(const std::vector<pid_t>& readers) {
+    bool ok = true;
+    for (pid_t pid : readers) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    return ok;
+}
+
+bool write_all(int fd, const char* bytes, std::size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, bytes, length);
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        length -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+void pipe_reader(int fd) {
+    std::uint64_t sum = 0;
+    std::size_t received = 0;
+    record buffer[1024];
+    std::size_t pending = 0;
+    while (received < record_count) {
+        ssize_t n = read(fd, reinterpret_cast<char*>(buffer) + pending, sizeof(buffer) - pending);
+        if (n <= 0) {
+            _exit(1);
+        }
+        pending += static_cast<std::size_t>(n);
+        std::size_t whole = pending / sizeof(record);
+        for (std::size_t i = 0; i < whole; ++i) {
+            sum += buffer[i].id;
+        }
+        received += whole;
+        pending -= whole * sizeof(record);
+        std::memmove(buffer, reinterpret_cast<char*>(buffer) + whole * sizeof(record), pending);
+    }
+    _exit(sum == expected_sum() ? 0 : 1);
+}
+
+double run_pipes() {
+    std::vector<int> write_ends;
+    std::vector<pid_t> readers;
+    for (int r = 0; r < reader_count; ++r) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::exit(1);
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            ::close(fds[1]);
+            pipe_reader(fds[0]);
+        }
+        ::close(fds[0]);
+        write_ends.push_back(fds[1]);
+        readers.push_back(pid);
+    }
+
+    auto start = bench::clock::now();
+    std::vector<record> batch;
+    for (std::size_t i = 0; i < record_count; ++i) {
+        batch.push_back(record{i, static_cast<double>(i) * 0.5});
+        if (batch.size() == 1024 || i + 1 == record_count) {
+            for (int fd : write_ends) {
+                write_all(fd, reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(record));
+            }
+            batch.clear();
+        }
+    }
+    for (int fd : write_ends) {
+        ::close(fd);
+    }
+    bool ok = wait_for_readers(readers);
+    auto end = bench::clock::now();
+    return ok ? static_cast<double>(bench::elapsed_ns(start, end)) / 1e6 : -1.0;
+}
+
+void shared_memory_reader() {
+    shared_memory_resource mr(segment_name);
+    offset_dynamic_array<record> records(mr);
+    std::uint64_t sum = 0;
+    std::size_t seen = 0;
+    while (seen < record_count) {
+        std::uint64_t partial = 0;
+        std::size_t upto = seen;
+        bool consistent = records.try_read([&](std::span<const record> view) {
+            for (std::size_t i = seen; i < view.size(); ++i) {
+                partial += view[i].id;
+            }
+            upto = std::max(seen, view.size());
+        });
+        if (consistent) {
+            sum += partial;
+            if (upto == seen) {
+                sched_yield();
+            }
+            seen = upto;
+        }
+    }
+    _exit(sum == expected_sum() ? 0 : 1);
+}
+
+double run_shared_memory() {
+    shared_memory_resource mr(segment_name, shared_memory_resource::create,
+                              std::size_t(4) * record_count * sizeof(record));
+    offset_dynamic_array<record> records(mr);
+
+    std::vector<pid_t> readers;
+    for (int r = 0; r < reader_count; ++r) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            shared_memory_reader();
+        }
+        readers.push_back(pid);
+    }
+
+    auto start = bench::clock::now();
+    for (std::size_t i = 0; i < record_count; ++i) {
+        records.push_back(record{i, static_cast<double>(i) * 0.5});
+    }
+    bool ok = wait_for_readers(readers);
+    auto end = bench::clock::now();
+    shared_memory_resource::remove(segment_name);
+    return ok ? static_cast<double>(bench::elapsed_ns(start, end)) / 1e6 : -1.0;
+}
+
+int main() {
+    double pipe_ms = run_pipes();
+    double shared_ms = run_shared_memory();
+    std::cout << "records=" << record_count << "\treaders=" << reader_count
+              << "\tpipe_ms=" << pipe_ms << "\tshared_memory_ms=" << shared_ms << std::endl;
+    return pipe_ms < 0 || shared_ms < 0 ? 1 : 0;
+}
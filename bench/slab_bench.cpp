@@ -0,0 +1,88 @@
+#include "dynamic_array.h"
+#include "slab_memory_resource.h"
+#include "bench_common.h"
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+struct person {
+    std::string name;
+    int age = 0;
+    double salary = 0.0;
+};
+
+// Many short dynamic_array<person> instances created and dropped at random.
+void tiny_arrays(std::pmr::memory_resource* mr) {
+    constexpr std::size_t slots = 4096;
+    std::vector<std::unique_ptr<dynamic_array<person>>> arrays(slots);
+    std::mt19937 rng(3);
+    for (std::size_t step = 0; step < 400000; ++step) {
+        auto& arr = arrays[rng() % slots];
+        if (arr) {
+            arr.reset();
+            continue;
+        }
+        arr = std::make_unique<dynamic_array<person>>(mr);
+        std::size_t count = 1 + rng() % 8;
+        for (std::size_t i = 0; i < count; ++i) {
+            arr->push_back(person{"", static_cast<int>(i), 0.0});
+        }
+    }
+}
+
+// Raw allocate/deallocate churn with sizes spread over every size class.
+void small_objects(std::pmr::memory_resource* mr) {
+    struct block {
+        void* p;
+        std::size_t size;
+    };
+    constexpr std::size_t slots = 16384;
+    std::vector<block> live(slots, block{nullptr, 0});
+    std::mt19937 rng(5);
+    for (std::size_t step = 0; step < 2000000; ++step) {
+        block& b = live[rng() % slots];
+        if (b.p) {
+            mr->deallocate(b.p, b.size);
+            b.p = nullptr;
+            continue;
+        }
+        b.size = 8 + rng() % 1017;
+        b.p = mr->allocate(b.size);
+    }
+    for (block& b : live) {
+        if (b.p) {
+            mr->deallocate(b.p, b.size);
+        }
+    }
+}
+
+template<typename Resource, typename Workload>
+void run(const char* name, const char* workload_name, Workload workload) {
+    bench::counting_resource upstream;
+    auto start = bench::clock::now();
+    {
+        Resource mr(&upstream);
+        workload(&mr);
+    }
+    auto end = bench::clock::now();
+
+    std::cout << name << "\tworkload=" << workload_name
+              << "\tms=" << static_cast<double>(bench::elapsed_ns(start, end)) / 1e6
+              << "\tpeak_upstream_bytes=" << upstream.peak_bytes()
+              << "\tupstream_calls=" << upstream.allocation_calls() << std::endl;
+}
+
+template<typename Workload>
+void run_all(const char* workload_name, Workload workload) {
+    run<slab_memory_resource>("slab", workload_name, workload);
+    run<std::pmr::unsynchronized_pool_resource>("unsynchronized_pool", workload_name, workload);
+    run<dynamic_list_memory_resource>("dynamic_list", workload_name, workload);
+}
+
+int main() {
+    run_all("tiny_arrays", tiny_arrays);
+    run_all("small_objects", small_objects);
+    return 0;
+}
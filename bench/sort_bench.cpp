@@ -0,0 +1,73 @@
+#include "dynamic_array.h"
+#include "bench_common.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+static_assert(std::contiguous_iterator<dynamic_array<int>::iterator>);
+static_assert(std::contiguous_iterator<dynamic_array<int>::const_iterator>);
+static_assert(std::ranges::contiguous_range<dynamic_array<int>>);
+static_assert(std::ranges::contiguous_range<const dynamic_array<int>>);
+static_assert(std::is_convertible_v<dynamic_array<int>&, std::span<int>>);
+
+// Runs the same algorithms over a dynamic_array<int> and a std::vector<int>
+// holding the same shuffled values. With contiguous iterators both should
+// take the library's pointer fast paths and land within noise of each other.
+template<typename Container>
+void run(const char* name, const std::vector<int>& values) {
+    constexpr int rounds = 10;
+    std::int64_t sort_ns = 0;
+    std::int64_t ranges_sort_ns = 0;
+    std::int64_t search_ns = 0;
+    std::int64_t copy_ns = 0;
+    std::size_t found = 0;
+
+    Container arr;
+    Container out;
+    arr.resize(values.size());
+    out.resize(values.size());
+    for (int round = 0; round < rounds; ++round) {
+        std::copy(values.begin(), values.end(), arr.begin());
+        auto start = bench::clock::now();
+        std::sort(arr.begin(), arr.end());
+        sort_ns += bench::elapsed_ns(start, bench::clock::now());
+
+        std::copy(values.begin(), values.end(), arr.begin());
+        start = bench::clock::now();
+        std::ranges::sort(arr);
+        ranges_sort_ns += bench::elapsed_ns(start, bench::clock::now());
+
+        start = bench::clock::now();
+        for (std::size_t i = 0; i < values.size(); i += 8) {
+            found += std::lower_bound(arr.begin(), arr.end(), values[i]) != arr.end();
+        }
+        search_ns += bench::elapsed_ns(start, bench::clock::now());
+
+        start = bench::clock::now();
+        std::copy(arr.begin(), arr.end(), out.begin());
+        copy_ns += bench::elapsed_ns(start, bench::clock::now());
+        bench::do_not_optimize(out.back());
+    }
+    bench::do_not_optimize(found);
+
+    std::cout << name << "\telements=" << values.size()
+              << "\tsort_ms=" << static_cast<double>(sort_ns) / rounds / 1e6
+              << "\tranges_sort_ms=" << static_cast<double>(ranges_sort_ns) / rounds / 1e6
+              << "\tlower_bound_ms=" << static_cast<double>(search_ns) / rounds / 1e6
+              << "\tcopy_ms=" << static_cast<double>(copy_ns) / rounds / 1e6 << std::endl;
+}
+
+int main() {
+    std::vector<int> values(std::size_t(1) << 22);
+    std::mt19937 rng(25);
+    for (int& v : values) {
+        v = static_cast<int>(rng());
+    }
+
+    run<std::vector<int>>("std_vector", values);
+    run<dynamic_array<int>>("dynamic_array", values);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "dynamic_array.h"
+#include "thread_caching_memory_resource.h"
+#include "bench_common.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Every thread repeatedly builds a short-lived dynamic_array<int>, so each
+// iteration is a chain of doubling allocations followed by frees.
+void worker(std::pmr::memory_resource* mr, std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+        dynamic_array<int> arr(mr);
+        for (int j = 0; j < 256; ++j) {
+            arr.push_back(j);
+        }
+        bench::do_not_optimize(arr.back());
+        arr.clear();
+    }
+}
+
+void run(const char* name, std::pmr::memory_resource* mr, std::size_t threads) {
+    constexpr std::size_t iterations = 20000;
+
+    auto start = bench::clock::now();
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back(worker, mr, iterations);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    auto end = bench::clock::now();
+
+    double seconds = static_cast<double>(bench::elapsed_ns(start, end)) / 1e9;
+    double arrays_per_second = static_cast<double>(threads * iterations) / seconds;
+    std::cout << name << "\tthreads=" << threads << "\tarrays_per_s=" << arrays_per_second << std::endl;
+}
+
+int main() {
+    std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        {
+            dynamic_list_memory_resource list;
+            bench::locked_resource locked(&list);
+            run("locked_dynamic_list", &locked, threads);
+        }
+        {
+            std::pmr::synchronized_pool_resource pool;
+            run("synchronized_pool", &pool, threads);
+        }
+        {
+            thread_caching_memory_resource caching;
+            run("thread_caching", &caching, threads);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "dynamic_array.h"
+#include "tlsf_memory_resource.h"
+#include "bench_common.h"
+#include <iostream>
+#include <vector>
+
+// Leaves `free_count` small free holes in the resource, then times
+// allocations that none of them can satisfy. Every timed allocation gets an
+// exact-size hole of its own, freed before the small ones, so nothing is
+// split and the small holes stay ahead of it in a first-fit search on every
+// call rather than only the first. Each hole sits between two allocated
+// keepers so no frees coalesce.
+template<typename Resource>
+void run(const char* name, std::size_t free_count) {
+    constexpr std::size_t small_size = 32;
+    constexpr std::size_t large_size = 256;
+    constexpr std::size_t keeper_size = 16;
+    constexpr std::size_t samples = 2000;
+
+    Resource mr;
+    std::vector<void*> keepers;
+    keepers.reserve(samples + free_count);
+    std::vector<void*> large_holes;
+    large_holes.reserve(samples);
+    for (std::size_t i = 0; i < samples; ++i) {
+        large_holes.push_back(mr.allocate(large_size));
+        keepers.push_back(mr.allocate(keeper_size));
+    }
+    std::vector<void*> small_holes;
+    small_holes.reserve(free_count);
+    for (std::size_t i = 0; i < free_count; ++i) {
+        small_holes.push_back(mr.allocate(small_size));
+        keepers.push_back(mr.allocate(keeper_size));
+    }
+    for (void* p : large_holes) {
+        mr.deallocate(p, large_size);
+    }
+    for (void* p : small_holes) {
+        mr.deallocate(p, small_size);
+    }
+
+    std::vector<void*> large_blocks;
+    large_blocks.reserve(samples);
+    std::vector<std::int64_t> timings;
+    timings.reserve(samples);
+    for (std::size_t i = 0; i < samples; ++i) {
+        auto start = bench::clock::now();
+        void* p = mr.allocate(large_size);
+        auto end = bench::clock::now();
+        bench::do_not_optimize(p);
+        large_blocks.push_back(p);
+        timings.push_back(bench::elapsed_ns(start, end));
+    }
+
+    std::cout << name << "\tfree_blocks=" << free_count
+              << "\tmean_ns=" << bench::mean(timings)
+              << "\tp50_ns=" << bench::percentile(timings, 0.50)
+              << "\tp99_ns=" << bench::percentile(timings, 0.99) << std::endl;
+
+    for (void* p : large_blocks) {
+        mr.deallocate(p, large_size);
+    }
+    for (void* p : keepers) {
+        mr.deallocate(p, keeper_size);
+    }
+}
+
+int main() {
+    for (std::size_t free_count : {0, 100, 1000, 10000}) {
+        run<dynamic_list_memory_resource>("dynamic_list", free_count);
+        run<tlsf_memory_resource>("tlsf", free_count);
+    }
+    return 0;
+}
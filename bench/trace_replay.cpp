@@ -0,0 +1,157 @@
+#include "dynamic_array.h"
+#include "tracing_memory_resource.h"
+#include "arena_memory_resource.h"
+#include "buddy_memory_resource.h"
+#include "lock_free_pool_resource.h"
+#include "slab_memory_resource.h"
+#include "thread_caching_memory_resource.h"
+#include "tlsf_memory_resource.h"
+#include "bench_common.h"
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Replays an allocation trace recorded by tracing_memory_resource against
+// every engine in the tree, in recorded order on one thread. Without an
+// argument a sample trace is recorded first from a synthetic dynamic_array
+// workload over dynamic_list, so it contains in-place expansions. A
+// successful recorded expansion is replayed as try_expand() and, where the
+// engine refuses, as the allocate-and-free a container would fall back to.
+//
+//     trace_replay [trace-file]
+
+void record_sample_trace(const std::string& path) {
+    dynamic_list_memory_resource engine;
+    tracing_memory_resource tracer(path, &engine);
+    constexpr std::size_t slots = 256;
+    std::vector<std::unique_ptr<dynamic_array<int>>> arrays(slots);
+    std::vector<std::unique_ptr<dynamic_array<std::pmr::string>>> names(slots);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> log_size(0.0, 12.0);
+    for (std::size_t step = 0; step < 20000; ++step) {
+        std::size_t slot = rng() % slots;
+        if (arrays[slot]) {
+            arrays[slot].reset();
+            names[slot].reset();
+            continue;
+        }
+        arrays[slot] = std::make_unique<dynamic_array<int>>(&tracer);
+        names[slot] = std::make_unique<dynamic_array<std::pmr::string>>(&tracer);
+        std::size_t target = static_cast<std::size_t>(std::exp2(log_size(rng)));
+        for (std::size_t i = 0; i < target; ++i) {
+            arrays[slot]->push_back(static_cast<int>(i));
+            if (i % 16 == 0) {
+                names[slot]->push_back(std::pmr::string(24 + i % 64, 'x', &tracer));
+            }
+        }
+    }
+}
+
+template<typename Resource>
+void replay(const char* name, const std::vector<allocation_trace_record>& trace) {
+    struct live_block {
+        void* p;
+        std::size_t size;
+        std::size_t alignment;
+    };
+
+    bench::counting_resource upstream;
+    std::unordered_map<std::uint64_t, live_block> live;
+    live.reserve(trace.size() / 2 + 1);
+    std::vector<std::int64_t> samples;
+    samples.reserve(trace.size());
+    std::int64_t total_ns = 0;
+    {
+        Resource mr(&upstream);
+        for (const allocation_trace_record& r : trace) {
+            if (r.kind == allocation_trace_record::allocate) {
+                auto start = bench::clock::now();
+                void* p = mr.allocate(static_cast<std::size_t>(r.size), r.alignment());
+                auto end = bench::clock::now();
+                samples.push_back(bench::elapsed_ns(start, end));
+                live[r.address] = live_block{p, static_cast<std::size_t>(r.size), r.alignment()};
+                continue;
+            }
+            if (r.kind == allocation_trace_record::good_size ||
+                (r.kind == allocation_trace_record::expand && !(r.flags & allocation_trace_record::expanded))) {
+                continue;
+            }
+            auto it = live.find(r.address);
+            if (it == live.end()) {
+                continue;
+            }
+            if (r.kind == allocation_trace_record::expand) {
+                live_block& block = it->second;
+                std::size_t new_size = static_cast<std::size_t>(r.size);
+                auto start = bench::clock::now();
+                if (!try_expand(&mr, block.p, block.size, new_size)) {
+                    void* p = mr.allocate(new_size, block.alignment);
+                    mr.deallocate(block.p, block.size, block.alignment);
+                    block.p = p;
+                }
+                auto end = bench::clock::now();
+                samples.push_back(bench::elapsed_ns(start, end));
+                block.size = new_size;
+                continue;
+            }
+            auto start = bench::clock::now();
+            mr.deallocate(it->second.p, static_cast<std::size_t>(r.size), r.alignment());
+            auto end = bench::clock::now();
+            samples.push_back(bench::elapsed_ns(start, end));
+            live.erase(it);
+        }
+        for (const auto& entry : live) {
+            mr.deallocate(entry.second.p, entry.second.size, entry.second.alignment);
+        }
+        live.clear();
+    }
+    for (std::int64_t s : samples) {
+        total_ns += s;
+    }
+
+    double ops_per_second = total_ns > 0 ? static_cast<double>(samples.size()) * 1e9 / static_cast<double>(total_ns) : 0.0;
+    std::cout << name << "\tops=" << samples.size()
+              << "\tops_per_s=" << ops_per_second
+              << "\tp50_ns=" << bench::percentile(samples, 0.50)
+              << "\tp99_ns=" << bench::percentile(samples, 0.99)
+              << "\tp999_ns=" << bench::percentile(samples, 0.999)
+              << "\tmax_ns=" << bench::percentile(samples, 1.0)
+              << "\tpeak_upstream_bytes=" << upstream.peak_bytes()
+              << "\tupstream_calls=" << upstream.allocation_calls() << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "trace_replay_sample.bin";
+    if (argc <= 1) {
+        record_sample_trace(path);
+    }
+
+    std::vector<allocation_trace_record> trace;
+    try {
+        trace = load_allocation_trace(path);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "trace=" << path << "\trecords=" << trace.size() << std::endl;
+
+    replay<bench::forwarding_resource>("new_delete", trace);
+    replay<std::pmr::unsynchronized_pool_resource>("unsynchronized_pool", trace);
+    replay<std::pmr::synchronized_pool_resource>("synchronized_pool", trace);
+    replay<std::pmr::monotonic_buffer_resource>("monotonic", trace);
+    replay<dynamic_list_memory_resource>("dynamic_list", trace);
+    replay<basic_dynamic_list_memory_resource<next_fit_policy>>("dynamic_list_next_fit", trace);
+    replay<basic_dynamic_list_memory_resource<best_fit_policy>>("dynamic_list_best_fit", trace);
+    replay<tlsf_memory_resource>("tlsf", trace);
+    replay<buddy_memory_resource>("buddy", trace);
+    replay<arena_memory_resource>("arena", trace);
+    replay<thread_caching_memory_resource>("thread_caching", trace);
+    replay<lock_free_pool_resource>("lock_free_pool", trace);
+    replay<slab_memory_resource>("slab", trace);
+    return 0;
+}
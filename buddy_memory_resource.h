@@ -0,0 +1,201 @@
+#pragma once
+#include "expandable_memory_resource.h"
+#include <memory_resource>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Binary buddy allocator over power-of-two arenas taken from upstream. Every
+// block is a power of two aligned to its own size, so the order of a block
+// follows from the size passed to deallocate and no per-block header is
+// needed. A per-arena bitmap records which blocks are free at each order.
+class buddy_memory_resource : public expandable_memory_resource {
+private:
+    static constexpr std::size_t min_order = 4;
+    static constexpr std::size_t max_supported_order = sizeof(std::size_t) * 8 - 2;
+    static constexpr std::size_t default_arena_size = std::size_t(1) << 20;
+
+    struct free_block {
+        free_block* next;
+        free_block* prev;
+    };
+
+    struct arena_header {
+        arena_header* next;
+        std::uint64_t* bitmap;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::size_t arena_order;
+    std::size_t bitmap_words;
+    arena_header* arenas = nullptr;
+    free_block* free_lists[max_supported_order + 1] = {};
+
+    std::size_t arena_size() const { return std::size_t(1) << arena_order; }
+
+    static std::size_t order_for(std::size_t bytes, std::size_t alignment) {
+        std::size_t size = std::max({bytes, alignment, std::size_t(1) << min_order});
+        return std::bit_width(size - 1);
+    }
+
+    std::size_t bit_index(std::size_t offset, std::size_t order) const {
+        std::size_t level_start = (std::size_t(1) << (arena_order - order)) - 1;
+        return level_start + (offset >> order);
+    }
+
+    char* arena_base(void* p) const {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<char*>(address & ~(std::uintptr_t(arena_size()) - 1));
+    }
+
+    void set_free(char* base, char* block, std::size_t order, bool value) {
+        std::uint64_t* bitmap = reinterpret_cast<arena_header*>(base)->bitmap;
+        std::size_t bit = bit_index(static_cast<std::size_t>(block - base), order);
+        if (value) {
+            bitmap[bit / 64] |= std::uint64_t(1) << (bit % 64);
+        } else {
+            bitmap[bit / 64] &= ~(std::uint64_t(1) << (bit % 64));
+        }
+    }
+
+    bool is_free(char* base, char* block, std::size_t order) const {
+        std::uint64_t* bitmap = reinterpret_cast<arena_header*>(base)->bitmap;
+        std::size_t bit = bit_index(static_cast<std::size_t>(block - base), order);
+        return (bitmap[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    void push(char* block, std::size_t order) {
+        free_block* node = reinterpret_cast<free_block*>(block);
+        node->next = free_lists[order];
+        node->prev = nullptr;
+        if (free_lists[order]) {
+            free_lists[order]->prev = node;
+        }
+        free_lists[order] = node;
+        set_free(arena_base(block), block, order, true);
+    }
+
+    void unlink(char* block, std::size_t order) {
+        free_block* node = reinterpret_cast<free_block*>(block);
+        if (node->next) {
+            node->next->prev = node->prev;
+        }
+        if (node->prev) {
+            node->prev->next = node->next;
+        } else {
+            free_lists[order] = node->next;
+        }
+        set_free(arena_base(block), block, order, false);
+    }
+
+    void add_arena() {
+        std::size_t bitmap_bytes = bitmap_words * sizeof(std::uint64_t);
+        std::uint64_t* bitmap = static_cast<std::uint64_t*>(upstream->allocate(bitmap_bytes, alignof(std::uint64_t)));
+        char* base;
+        try {
+            base = static_cast<char*>(upstream->allocate(arena_size(), arena_size()));
+        } catch (...) {
+            upstream->deallocate(bitmap, bitmap_bytes, alignof(std::uint64_t));
+            throw;
+        }
+        std::fill(bitmap, bitmap + bitmap_words, std::uint64_t(0));
+
+        arena_header* arena = reinterpret_cast<arena_header*>(base);
+        arena->bitmap = bitmap;
+        arena->next = arenas;
+        arenas = arena;
+
+        // The arena header occupies the first min_order block; every upper
+        // half on the way down becomes a free block of its order.
+        for (std::size_t order = arena_order; order-- > min_order;) {
+            push(base + (std::size_t(1) << order), order);
+        }
+    }
+
+public:
+    buddy_memory_resource() : buddy_memory_resource(std::pmr::get_default_resource()) {}
+
+    explicit buddy_memory_resource(std::pmr::memory_resource* upstream_mr,
+                                   std::size_t arena_bytes = default_arena_size)
+        : upstream(upstream_mr) {
+        std::size_t order = std::bit_width(std::max(arena_bytes, std::size_t(1) << (min_order + 2)) - 1);
+        arena_order = std::min(order, max_supported_order);
+        std::size_t bits = (std::size_t(1) << (arena_order - min_order + 1)) - 1;
+        bitmap_words = (bits + 63) / 64;
+    }
+
+    buddy_memory_resource(const buddy_memory_resource&) = delete;
+    buddy_memory_resource& operator=(const buddy_memory_resource&) = delete;
+
+    ~buddy_memory_resource() override {
+        while (arenas) {
+            arena_header* next = arenas->next;
+            upstream->deallocate(arenas->bitmap, bitmap_words * sizeof(std::uint64_t), alignof(std::uint64_t));
+            upstream->deallocate(arenas, arena_size(), arena_size());
+            arenas = next;
+        }
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::size_t order = order_for(bytes, alignment);
+        if (order >= arena_order) {
+            return upstream->allocate(bytes, alignment);
+        }
+
+        std::size_t found = order;
+        while (found < arena_order && !free_lists[found]) {
+            ++found;
+        }
+        if (found == arena_order) {
+            add_arena();
+            found = order;
+            while (!free_lists[found]) {
+                ++found;
+            }
+        }
+
+        char* block = reinterpret_cast<char*>(free_lists[found]);
+        unlink(block, found);
+        while (found > order) {
+            --found;
+            push(block + (std::size_t(1) << found), found);
+        }
+        return block;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::size_t order = order_for(bytes, alignment);
+        if (order >= arena_order) {
+            upstream->deallocate(p, bytes, alignment);
+            return;
+        }
+
+        char* block = static_cast<char*>(p);
+        char* base = arena_base(block);
+        while (order + 1 < arena_order) {
+            std::size_t offset = static_cast<std::size_t>(block - base);
+            char* buddy = base + (offset ^ (std::size_t(1) << order));
+            if (!is_free(base, buddy, order)) {
+                break;
+            }
+            unlink(buddy, order);
+            block = std::min(block, buddy);
+            ++order;
+        }
+        push(block, order);
+    }
+
+    std::size_t do_good_size(std::size_t bytes, std::size_t alignment) const override {
+        std::size_t order = order_for(bytes, alignment);
+        return order >= arena_order ? bytes : std::size_t(1) << order;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
@@ -1,69 +1,621 @@
 #pragma once
 #include <memory_resource>
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iterator>
+#include <memory>
 #include <stdexcept>
-#include <list>
+#include <new>
+#include <span>
+#include <type_traits>
+#include "expandable_memory_resource.h"
+#include "memory_resource_stats.h"
 
-class dynamic_list_memory_resource : public std::pmr::memory_resource {
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Block metadata lives inside the managed memory. Every block is preceded
+// by a header holding its physical predecessor and its size (low bit set
+// while free), and a free block keeps the fit policy's links in its own
+// payload. On 64-bit targets that is 16 bytes per block with a 32-byte
+// minimum block, plus a 16-byte chunk header and a 16-byte end sentinel per
+// chunk. Builds without NDEBUG add a canary word, making headers 32 bytes.
+struct alignas(std::max_align_t) dynamic_list_block {
+    dynamic_list_block* prev_phys;
+    std::size_t size;
+#ifndef NDEBUG
+    std::uintptr_t canary;
+#endif
+
+    std::size_t block_size() const { return size & ~(alignof(std::max_align_t) - 1); }
+
+    template<typename Links>
+    Links* links() {
+        return reinterpret_cast<Links*>(reinterpret_cast<char*>(this) + sizeof(dynamic_list_block));
+    }
+};
+
+class first_fit_policy {
+public:
+    struct links_type {
+        dynamic_list_block* next;
+        dynamic_list_block* prev;
+    };
+
+protected:
+    dynamic_list_block* head = nullptr;
+
+    static links_type* links(dynamic_list_block* b) { return b->links<links_type>(); }
+
+public:
+    void insert(dynamic_list_block* b) {
+        links(b)->next = head;
+        links(b)->prev = nullptr;
+        if (head) {
+            links(head)->prev = b;
+        }
+        head = b;
+    }
+
+    void remove(dynamic_list_block* b) {
+        dynamic_list_block* next = links(b)->next;
+        dynamic_list_block* prev = links(b)->prev;
+        if (next) {
+            links(next)->prev = prev;
+        }
+        if (prev) {
+            links(prev)->next = next;
+        } else {
+            head = next;
+        }
+    }
+
+    template<typename Fits>
+    dynamic_list_block* find(std::size_t, Fits fits) {
+        for (dynamic_list_block* b = head; b; b = links(b)->next) {
+            if (fits(b)) {
+                return b;
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename F>
+    void for_each(F f) const {
+        for (dynamic_list_block* b = head; b; b = links(b)->next) {
+            f(b);
+        }
+    }
+};
+
+class next_fit_policy : public first_fit_policy {
 private:
-    struct block_info {
-        void* ptr;
+    dynamic_list_block* rover = nullptr;
+
+public:
+    void remove(dynamic_list_block* b) {
+        if (rover == b) {
+            rover = links(b)->next;
+        }
+        first_fit_policy::remove(b);
+    }
+
+    template<typename Fits>
+    dynamic_list_block* find(std::size_t, Fits fits) {
+        dynamic_list_block* start = rover ? rover : head;
+        for (dynamic_list_block* b = start; b; b = links(b)->next) {
+            if (fits(b)) {
+                rover = b;
+                return b;
+            }
+        }
+        for (dynamic_list_block* b = head; b != start; b = links(b)->next) {
+            if (fits(b)) {
+                rover = b;
+                return b;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Free blocks ordered by (size, address) in a treap whose priorities are
+// derived from the block address, so no extra field is stored per node.
+class best_fit_policy {
+public:
+    struct links_type {
+        dynamic_list_block* left;
+        dynamic_list_block* right;
+    };
+
+private:
+    dynamic_list_block* root = nullptr;
+
+    static links_type* links(dynamic_list_block* b) { return b->links<links_type>(); }
+
+    static bool less(const dynamic_list_block* a, const dynamic_list_block* b) {
+        if (a->block_size() != b->block_size()) {
+            return a->block_size() < b->block_size();
+        }
+        return std::less<const dynamic_list_block*>()(a, b);
+    }
+
+    static std::uint64_t priority(const dynamic_list_block* b) {
+        std::uint64_t x = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(b));
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    static void split(dynamic_list_block* t, const dynamic_list_block* key,
+                      dynamic_list_block*& left, dynamic_list_block*& right) {
+        if (!t) {
+            left = right = nullptr;
+        } else if (less(t, key)) {
+            split(links(t)->right, key, links(t)->right, right);
+            left = t;
+        } else {
+            split(links(t)->left, key, left, links(t)->left);
+            right = t;
+        }
+    }
+
+    static dynamic_list_block* merge(dynamic_list_block* left, dynamic_list_block* right) {
+        if (!left) {
+            return right;
+        }
+        if (!right) {
+            return left;
+        }
+        if (priority(left) > priority(right)) {
+            links(left)->right = merge(links(left)->right, right);
+            return left;
+        }
+        links(right)->left = merge(left, links(right)->left);
+        return right;
+    }
+
+    template<typename Fits>
+    static dynamic_list_block* search(dynamic_list_block* t, std::size_t size, Fits& fits) {
+        while (t) {
+            if (t->block_size() >= size) {
+                if (dynamic_list_block* found = search(links(t)->left, size, fits)) {
+                    return found;
+                }
+                if (fits(t)) {
+                    return t;
+                }
+            }
+            t = links(t)->right;
+        }
+        return nullptr;
+    }
+
+    template<typename F>
+    static void visit(dynamic_list_block* t, F& f) {
+        while (t) {
+            visit(links(t)->left, f);
+            f(t);
+            t = links(t)->right;
+        }
+    }
+
+public:
+    void insert(dynamic_list_block* b) {
+        dynamic_list_block** link = &root;
+        while (*link && priority(*link) >= priority(b)) {
+            link = less(b, *link) ? &links(*link)->left : &links(*link)->right;
+        }
+        split(*link, b, links(b)->left, links(b)->right);
+        *link = b;
+    }
+
+    void remove(dynamic_list_block* b) {
+        dynamic_list_block** link = &root;
+        while (*link != b) {
+            link = less(b, *link) ? &links(*link)->left : &links(*link)->right;
+        }
+        *link = merge(links(b)->left, links(b)->right);
+    }
+
+    template<typename Fits>
+    dynamic_list_block* find(std::size_t size, Fits fits) {
+        return search(root, size, fits);
+    }
+
+    template<typename F>
+    void for_each(F f) const {
+        visit(root, f);
+    }
+};
+
+template<typename FitPolicy = first_fit_policy>
+class basic_dynamic_list_memory_resource : public expandable_memory_resource {
+private:
+    using block_header = dynamic_list_block;
+
+    static constexpr std::size_t min_alignment = alignof(std::max_align_t);
+    static constexpr std::size_t default_chunk_size = 4096;
+
+    struct alignas(std::max_align_t) chunk_header {
+        chunk_header* next;
         std::size_t size;
-        block_info(void* p, std::size_t s) : ptr(p), size(s) {}
     };
-    
-    std::list<block_info> allocated_blocks;
-    std::list<block_info> free_blocks;
+
+    static constexpr std::size_t header_size = sizeof(block_header);
+    static constexpr std::size_t chunk_header_size = sizeof(chunk_header);
+    static constexpr std::size_t min_payload =
+        (sizeof(typename FitPolicy::links_type) + min_alignment - 1) & ~(min_alignment - 1);
+    static constexpr std::size_t min_block = header_size + min_payload;
+    static constexpr std::size_t chunk_overhead = chunk_header_size + 2 * header_size;
+    static constexpr std::size_t free_bit = 1;
+    static constexpr std::size_t purged_bit = 2;
+
+    std::pmr::memory_resource* upstream;
+    std::size_t first_chunk_size;
+    std::size_t next_chunk_size;
+    double growth_factor;
+    chunk_header* chunks = nullptr;
+    FitPolicy free_blocks;
+    std::size_t free_count = 0;
+    memory_resource_stats counters;
+
+    static std::size_t round_up(std::size_t n, std::size_t alignment) {
+        return (n + alignment - 1) & ~(alignment - 1);
+    }
+
+    static std::size_t block_size(const block_header* b) { return b->block_size(); }
+    static bool is_free(const block_header* b) { return (b->size & free_bit) != 0; }
+
+    static char* payload(block_header* b) { return reinterpret_cast<char*>(b) + header_size; }
+    static block_header* from_payload(void* p) {
+        return reinterpret_cast<block_header*>(static_cast<char*>(p) - header_size);
+    }
+    static block_header* next_phys(block_header* b) {
+        return reinterpret_cast<block_header*>(payload(b) + block_size(b));
+    }
+    static block_header* first_block(chunk_header* chunk) {
+        return reinterpret_cast<block_header*>(reinterpret_cast<char*>(chunk) + chunk_header_size);
+    }
+
+#ifndef NDEBUG
+    static std::uintptr_t canary_of(const block_header* b) {
+        return reinterpret_cast<std::uintptr_t>(b) ^ static_cast<std::uintptr_t>(0x9e37'79b9'7f4a'7c15ULL);
+    }
+#endif
+
+    static void stamp(block_header* b) {
+#ifndef NDEBUG
+        b->canary = canary_of(b);
+#else
+        (void)b;
+#endif
+    }
+
+    static void unstamp(block_header* b) {
+#ifndef NDEBUG
+        b->canary = 0;
+#else
+        (void)b;
+#endif
+    }
+
+    void insert_free(block_header* b) {
+        free_blocks.insert(b);
+        b->size |= free_bit;
+        ++free_count;
+    }
+
+    void remove_free(block_header* b) {
+        free_blocks.remove(b);
+        b->size &= ~(free_bit | purged_bit);
+        --free_count;
+    }
+
+    block_header* split(block_header* b, std::size_t size) {
+        block_header* rest = reinterpret_cast<block_header*>(payload(b) + size);
+        stamp(rest);
+        rest->prev_phys = b;
+        rest->size = block_size(b) - size - header_size;
+        next_phys(rest)->prev_phys = rest;
+        b->size = size | (b->size & (free_bit | purged_bit));
+        ++counters.splits;
+        return rest;
+    }
+
+    block_header* merge_with_next(block_header* b) {
+        block_header* next = next_phys(b);
+        b->size += block_size(next) + header_size;
+        unstamp(next);
+        next_phys(b)->prev_phys = b;
+        ++counters.merges;
+        return b;
+    }
+
+    static std::size_t aligned_padding(block_header* b, std::size_t alignment) {
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(payload(b));
+        std::uintptr_t aligned = (base + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        if (aligned != base && aligned - base < min_block) {
+            aligned = (base + min_block + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        }
+        return static_cast<std::size_t>(aligned - base);
+    }
+
+    void* take(block_header* b, std::size_t size, std::size_t padding) {
+        remove_free(b);
+        if (padding > 0) {
+            block_header* rest = split(b, padding - header_size);
+            insert_free(b);
+            b = rest;
+        }
+        if (block_size(b) >= size + min_block) {
+            insert_free(split(b, size));
+        }
+        return payload(b);
+    }
+
+    block_header* allocate_chunk(std::size_t size, std::size_t alignment) {
+        std::size_t needed = size + chunk_overhead;
+        if (alignment > min_alignment) {
+            needed += alignment + min_block;
+        }
+        std::size_t bytes = round_up(std::max(next_chunk_size, needed), min_alignment);
+
+        chunk_header* chunk = static_cast<chunk_header*>(upstream->allocate(bytes, min_alignment));
+        chunk->next = chunks;
+        chunk->size = bytes;
+        chunks = chunk;
+        counters.upstream_bytes += bytes;
+        ++counters.upstream_chunks;
+
+        double grown = static_cast<double>(next_chunk_size) * growth_factor;
+        if (grown < static_cast<double>(std::size_t(-1) / 2)) {
+            next_chunk_size = std::max(next_chunk_size, static_cast<std::size_t>(grown));
+        }
+
+        block_header* b = first_block(chunk);
+        stamp(b);
+        b->prev_phys = nullptr;
+        b->size = bytes - chunk_overhead;
+
+        block_header* sentinel = next_phys(b);
+        stamp(sentinel);
+        sentinel->prev_phys = b;
+        sentinel->size = 0;
+
+        insert_free(b);
+        return b;
+    }
+
+#ifndef NDEBUG
+    // Constant-time check that b is a live block header: it carries its
+    // canary, is in use, and both physical neighbours carry theirs and point
+    // back at it. Headers absorbed by a merge lose their canary, so a stale
+    // or foreign pointer fails here rather than corrupting the chunk.
+    static bool looks_allocated(block_header* b) {
+        if (b->canary != canary_of(b) || is_free(b) || block_size(b) == 0) {
+            return false;
+        }
+        block_header* prev = b->prev_phys;
+        if (prev && (prev->canary != canary_of(prev) || next_phys(prev) != b)) {
+            return false;
+        }
+        block_header* next = next_phys(b);
+        return next->canary == canary_of(next) && next->prev_phys == b;
+    }
+#endif
+
+    std::size_t purge_pages(block_header* b) {
+#if defined(__linux__)
+        static const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::uintptr_t from = reinterpret_cast<std::uintptr_t>(payload(b) + min_payload);
+        std::uintptr_t to = reinterpret_cast<std::uintptr_t>(next_phys(b));
+        from = (from + page_size - 1) & ~(std::uintptr_t(page_size) - 1);
+        to &= ~(std::uintptr_t(page_size) - 1);
+        if (from >= to || madvise(reinterpret_cast<void*>(from), to - from, MADV_DONTNEED) != 0) {
+            return 0;
+        }
+        b->size |= purged_bit;
+        return static_cast<std::size_t>(to - from);
+#else
+        (void)b;
+        return 0;
+#endif
+    }
 
 public:
-    dynamic_list_memory_resource() = default;
+    basic_dynamic_list_memory_resource()
+        : basic_dynamic_list_memory_resource(std::pmr::get_default_resource()) {}
+
+    explicit basic_dynamic_list_memory_resource(std::pmr::memory_resource* upstream_mr,
+                                                std::size_t initial_chunk_size = default_chunk_size,
+                                                double chunk_growth_factor = 2.0)
+        : upstream(upstream_mr),
+          first_chunk_size(std::max<std::size_t>(initial_chunk_size, chunk_overhead + min_block)),
+          next_chunk_size(first_chunk_size),
+          growth_factor(chunk_growth_factor < 1.0 ? 1.0 : chunk_growth_factor) {}
+
+    basic_dynamic_list_memory_resource(const basic_dynamic_list_memory_resource&) = delete;
+    basic_dynamic_list_memory_resource& operator=(const basic_dynamic_list_memory_resource&) = delete;
+
+    ~basic_dynamic_list_memory_resource() override {
+        release();
+    }
 
-    ~dynamic_list_memory_resource() override {
-        for (const auto& block : allocated_blocks) {
-            ::operator delete(block.ptr);
+    // Forgets every allocation and returns all chunks to upstream. Only the
+    // chunk list is walked, so the cost does not depend on how many blocks
+    // the chunks were split into.
+    void release() {
+        while (chunks) {
+            chunk_header* next = chunks->next;
+            upstream->deallocate(chunks, chunks->size, min_alignment);
+            chunks = next;
         }
-        for (const auto& block : free_blocks) {
-            ::operator delete(block.ptr);
+        free_blocks = FitPolicy{};
+        free_count = 0;
+        next_chunk_size = first_chunk_size;
+        counters.bytes_live = 0;
+        counters.upstream_bytes = 0;
+        counters.upstream_chunks = 0;
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream; }
+
+    std::size_t chunk_count() const {
+        std::size_t count = 0;
+        for (chunk_header* chunk = chunks; chunk; chunk = chunk->next) {
+            ++count;
         }
+        return count;
     }
 
-protected:
-    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
-        auto it = free_blocks.begin();
-        while (it != free_blocks.end()) {
-            if (it->size >= bytes) {
-                void* result = it->ptr;
-                std::size_t remaining_size = it->size - bytes;
-                
-                if (remaining_size > 0) {
-                    void* free_part = static_cast<char*>(result) + bytes;
-                    free_blocks.emplace_front(free_part, remaining_size);
+    std::size_t free_block_count() const { return free_count; }
+
+    double fragmentation() const {
+        std::size_t total = 0;
+        std::size_t largest = 0;
+        free_blocks.for_each([&](const block_header* b) {
+            total += block_size(b);
+            largest = std::max(largest, block_size(b));
+        });
+        return total == 0 ? 0.0 : 1.0 - static_cast<double>(largest) / static_cast<double>(total);
+    }
+
+    // Returns whole free chunks to upstream and, on Linux, drops the pages
+    // inside the remaining free blocks, leaving keep_bytes of free memory
+    // untouched. Returns the number of bytes given back; purged ranges count
+    // in full even if some of their pages were never touched.
+    std::size_t trim(std::size_t keep_bytes = 0) {
+        std::size_t returned = 0;
+        std::size_t kept = 0;
+
+        chunk_header** link = &chunks;
+        while (*link) {
+            chunk_header* chunk = *link;
+            block_header* b = first_block(chunk);
+            if (is_free(b) && block_size(next_phys(b)) == 0) {
+                if (kept < keep_bytes) {
+                    kept += block_size(b);
+                } else {
+                    remove_free(b);
+                    *link = chunk->next;
+                    returned += chunk->size;
+                    counters.upstream_bytes -= chunk->size;
+                    --counters.upstream_chunks;
+                    upstream->deallocate(chunk, chunk->size, min_alignment);
+                    continue;
                 }
-                
-                free_blocks.erase(it);
-                allocated_blocks.emplace_front(result, bytes);
-                return result;
             }
-            ++it;
+            link = &chunk->next;
         }
-        
-        void* new_block = ::operator new(bytes);
-        allocated_blocks.emplace_front(new_block, bytes);
-        return new_block;
-    }
 
-    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
-        auto it = allocated_blocks.begin();
-        while (it != allocated_blocks.end()) {
-            if (it->ptr == p) {
-                free_blocks.splice(free_blocks.begin(), allocated_blocks, it);
+        // Chunks still wholly free here were kept above and already counted.
+        free_blocks.for_each([&](block_header* b) {
+            if ((b->size & purged_bit) || (!b->prev_phys && block_size(next_phys(b)) == 0)) {
                 return;
             }
-            ++it;
+            if (kept < keep_bytes) {
+                kept += block_size(b);
+            } else {
+                returned += purge_pages(b);
+            }
+        });
+
+        counters.bytes_trimmed += returned;
+        return returned;
+    }
+
+    memory_resource_stats stats() const {
+        memory_resource_stats snapshot = counters;
+        snapshot.free_blocks = free_count;
+        snapshot.fragmentation = fragmentation();
+        return snapshot;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (bytes > std::size_t(-1) / 4 || alignment > std::size_t(-1) / 4) {
+            throw std::bad_alloc();
         }
-        
-        throw std::runtime_error("Attempt to deallocate non-allocated memory");
+        std::size_t size = round_up(std::max(bytes, min_payload), min_alignment);
+
+        block_header* b = free_blocks.find(size, [&](block_header* candidate) {
+            ++counters.search_steps;
+            std::size_t padding = alignment > min_alignment ? aligned_padding(candidate, alignment) : 0;
+            return block_size(candidate) >= padding + size;
+        });
+        if (!b) {
+            b = allocate_chunk(size, alignment);
+        }
+        void* result = take(b, size, alignment > min_alignment ? aligned_padding(b, alignment) : 0);
+
+        ++counters.allocations;
+        counters.bytes_live += bytes;
+        counters.bytes_high_water = std::max(counters.bytes_high_water, counters.bytes_live);
+        return result;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t /*alignment*/) override {
+        block_header* b = from_payload(p);
+#ifndef NDEBUG
+        if (!looks_allocated(b) || block_size(b) < bytes) {
+            throw std::runtime_error("Attempt to deallocate non-allocated memory");
+        }
+#endif
+        ++counters.deallocations;
+        counters.bytes_live -= bytes;
+
+        block_header* next = next_phys(b);
+        if (is_free(next)) {
+            remove_free(next);
+            merge_with_next(b);
+        }
+
+        block_header* prev = b->prev_phys;
+        if (prev && is_free(prev)) {
+            remove_free(prev);
+            b = merge_with_next(prev);
+        }
+
+        insert_free(b);
+    }
+
+    bool do_try_expand(void* p, std::size_t old_bytes, std::size_t new_bytes) override {
+        block_header* b = from_payload(p);
+        std::size_t size = round_up(std::max(new_bytes, min_payload), min_alignment);
+        if (size > block_size(b)) {
+            block_header* next = next_phys(b);
+            if (!is_free(next) || block_size(b) + header_size + block_size(next) < size) {
+                return false;
+            }
+            remove_free(next);
+            merge_with_next(b);
+            if (block_size(b) >= size + min_block) {
+                insert_free(split(b, size));
+            }
+        } else if (block_size(b) >= size + min_block) {
+            block_header* rest = split(b, size);
+            block_header* next = next_phys(rest);
+            if (is_free(next)) {
+                remove_free(next);
+                merge_with_next(rest);
+            }
+            insert_free(rest);
+        }
+
+        counters.bytes_live += new_bytes - old_bytes;
+        counters.bytes_high_water = std::max(counters.bytes_high_water, counters.bytes_live);
+        return true;
+    }
+
+    std::size_t do_good_size(std::size_t bytes, std::size_t) const override {
+        return round_up(std::max(bytes, min_payload), min_alignment);
     }
 
     bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
@@ -71,112 +623,279 @@ protected:
     }
 };
 
+using dynamic_list_memory_resource = basic_dynamic_list_memory_resource<>;
+
+struct adopt_storage_t {
+    explicit adopt_storage_t() = default;
+};
+
+inline constexpr adopt_storage_t adopt_storage{};
+
+// Whether moving a T and destroying the source amounts to copying its bytes.
+// dynamic_array relocates such elements with memcpy. Trivially copyable types
+// qualify; other types whose members never point into the object itself
+// (std::unique_ptr, most pimpl classes) can opt in by specialising this.
+// libstdc++'s std::string keeps a pointer to its inline buffer, so types
+// holding one must not.
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
 template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Growth policies pick the capacity dynamic_array grows to once `required`
+// elements no longer fit in `capacity`. The array may round the result up
+// further to what its memory resource would hand out anyway.
+template<std::size_t Numerator, std::size_t Denominator, std::size_t Initial = 4>
+struct geometric_growth {
+    static_assert(Numerator > Denominator, "Geometric growth needs a factor above one");
+
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t) {
+        std::size_t grown = capacity == 0 ? Initial : capacity / Denominator * Numerator +
+                                                      capacity % Denominator * Numerator / Denominator;
+        return std::max(grown, required);
+    }
+};
+
+using doubling_growth = geometric_growth<2, 1>;
+using one_and_half_growth = geometric_growth<3, 2>;
+
+template<std::size_t Increment>
+struct fixed_increment_growth {
+    static_assert(Increment > 0, "Fixed growth needs a positive increment");
+
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t) {
+        return std::max(capacity + Increment, required);
+    }
+};
+
+// Grows like Base, then rounds buffers of at least a page up to whole
+// pages. Smaller buffers keep Base's capacity.
+template<typename Base = doubling_growth, std::size_t PageSize = 4096>
+struct page_rounded_growth {
+    static std::size_t next_capacity(std::size_t capacity, std::size_t required, std::size_t element_size) {
+        std::size_t grown = Base::next_capacity(capacity, required, element_size);
+        std::size_t bytes = grown * element_size;
+        if (bytes < PageSize) {
+            return grown;
+        }
+        bytes = (bytes + PageSize - 1) / PageSize * PageSize;
+        return bytes / element_size;
+    }
+};
+
+template<typename T, typename GrowthPolicy = doubling_growth>
 class dynamic_array {
 private:
     std::pmr::polymorphic_allocator<T> allocator;
-    T* data = nullptr;
+    T* data_ = nullptr;
     std::size_t capacity_ = 0;
     std::size_t size_ = 0;
 
-    void resize_if_needed() {
-        if (size_ >= capacity_) {
-            std::size_t new_capacity = capacity_ == 0 ? 4 : capacity_ * 2;
-            T* new_data = allocator.allocate(new_capacity);
-            
+    // Raises a capacity to everything the resource would hand out for it.
+    std::size_t fit_capacity(std::size_t capacity) const {
+        std::size_t usable = good_size(allocator.resource(), capacity * sizeof(T), alignof(T)) / sizeof(T);
+        return std::max(usable, capacity);
+    }
+
+    std::size_t grown_capacity(std::size_t required) const {
+        return fit_capacity(GrowthPolicy::next_capacity(capacity_, required, sizeof(T)));
+    }
+
+    bool expand_in_place(std::size_t new_capacity) {
+        if (!data_ || !try_expand(allocator.resource(), data_, capacity_ * sizeof(T), new_capacity * sizeof(T))) {
+            return false;
+        }
+        capacity_ = new_capacity;
+        return true;
+    }
+
+    static void destroy_elements(T* first, std::size_t count) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            std::destroy_n(first, count);
+        }
+    }
+
+    // Copy-constructs count elements into raw storage; on a throw the ones
+    // already built are destroyed again.
+    static void copy_elements(const T* from, std::size_t count, T* to) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count) {
+                std::memcpy(static_cast<void*>(to), from, count * sizeof(T));
+            }
+        } else {
+            std::uninitialized_copy_n(from, count, to);
+        }
+    }
+
+    // Moves the elements into a fresh buffer of new_capacity. If a copy
+    // throws, the new buffer is released and the array is left untouched.
+    void relocate(std::size_t new_capacity) {
+        T* new_data = allocator.allocate(new_capacity);
+
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (size_) {
+                std::memcpy(static_cast<void*>(new_data), static_cast<const void*>(data_), size_ * sizeof(T));
+            }
+        } else {
             for (std::size_t i = 0; i < size_; ++i) {
                 try {
-                    std::construct_at(new_data + i, std::move_if_noexcept(data[i]));
+                    std::construct_at(new_data + i, std::move_if_noexcept(data_[i]));
                 } catch (...) {
-                    for (std::size_t j = 0; j < i; ++j) {
-                        std::destroy_at(new_data + j);
-                    }
+                    destroy_elements(new_data, i);
                     allocator.deallocate(new_data, new_capacity);
                     throw;
                 }
             }
-            
-            for (std::size_t i = 0; i < size_; ++i) {
-                std::destroy_at(data + i);
-            }
-            if (data) {
-                allocator.deallocate(data, capacity_);
+            destroy_elements(data_, size_);
+        }
+        if (data_) {
+            allocator.deallocate(data_, capacity_);
+        }
+        
+        data_ = new_data;
+        capacity_ = new_capacity;
+    }
+
+    void resize_if_needed() {
+        if (size_ >= capacity_) {
+            std::size_t new_capacity = grown_capacity(size_ + 1);
+            if (!expand_in_place(new_capacity)) {
+                relocate(new_capacity);
             }
-            
-            data = new_data;
-            capacity_ = new_capacity;
         }
     }
 
 public:
     using value_type = T;
     using allocator_type = std::pmr::polymorphic_allocator<T>;
+    using growth_policy = GrowthPolicy;
 
-    class iterator {
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+
+private:
+    // Contiguous iterator over U, which is T or const T. An iterator
+    // converts to the matching const iterator.
+    template<typename U>
+    class basic_iterator {
     private:
-        T* ptr;
+        U* ptr;
 
     public:
-        using iterator_category = std::forward_iterator_tag;
-        using value_type = T;
+        using iterator_concept = std::contiguous_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<U>;
+        using element_type = U;
         using difference_type = std::ptrdiff_t;
-        using pointer = T*;
-        using reference = T&;
+        using pointer = U*;
+        using reference = U&;
 
-        explicit iterator(T* p = nullptr) : ptr(p) {}
+        basic_iterator() : ptr(nullptr) {}
+        explicit basic_iterator(U* p) : ptr(p) {}
+
+        template<typename V>
+            requires std::is_convertible_v<V*, U*>
+        basic_iterator(const basic_iterator<V>& other) : ptr(other.operator->()) {}
 
         reference operator*() const { return *ptr; }
         pointer operator->() const { return ptr; }
+        reference operator[](difference_type n) const { return ptr[n]; }
 
-        iterator& operator++() {
+        basic_iterator& operator++() {
             ++ptr;
             return *this;
         }
 
-        iterator operator++(int) {
-            iterator tmp = *this;
+        basic_iterator operator++(int) {
+            basic_iterator tmp = *this;
             ++ptr;
             return tmp;
         }
 
-        bool operator==(const iterator& other) const { return ptr == other.ptr; }
-        bool operator!=(const iterator& other) const { return ptr != other.ptr; }
+        basic_iterator& operator--() {
+            --ptr;
+            return *this;
+        }
+
+        basic_iterator operator--(int) {
+            basic_iterator tmp = *this;
+            --ptr;
+            return tmp;
+        }
+
+        basic_iterator& operator+=(difference_type n) {
+            ptr += n;
+            return *this;
+        }
+
+        basic_iterator& operator-=(difference_type n) {
+            ptr -= n;
+            return *this;
+        }
+
+        friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const basic_iterator& a, const basic_iterator& b) { return a.ptr - b.ptr; }
+
+        bool operator==(const basic_iterator& other) const { return ptr == other.ptr; }
+        auto operator<=>(const basic_iterator& other) const { return ptr <=> other.ptr; }
     };
 
+public:
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<const T>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
     explicit dynamic_array(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
-        : allocator(mr), data(nullptr), capacity_(0), size_(0) {}
+        : allocator(mr), data_(nullptr), capacity_(0), size_(0) {}
 
     dynamic_array(std::size_t initial_size, std::pmr::memory_resource* mr = std::pmr::get_default_resource())
         : allocator(mr), capacity_(initial_size), size_(initial_size) {
         if (initial_size > 0) {
-            data = allocator.allocate(capacity_);
+            data_ = allocator.allocate(capacity_);
             for (std::size_t i = 0; i < size_; ++i) {
-                std::construct_at(data + i);
+                std::construct_at(data_ + i);
             }
         }
     }
 
+    // Takes ownership of `storage`, which must have been allocated from `mr`
+    // for `capacity` elements and hold `size` constructed elements.
+    dynamic_array(adopt_storage_t, T* storage, std::size_t size, std::size_t capacity,
+                  std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : allocator(mr), data_(storage), capacity_(capacity), size_(size) {}
+
     ~dynamic_array() {
         clear();
-        if (data) {
-            allocator.deallocate(data, capacity_);
+        if (data_) {
+            allocator.deallocate(data_, capacity_);
         }
     }
 
     dynamic_array(const dynamic_array& other)
         : allocator(other.allocator), capacity_(other.capacity_), size_(other.size_) {
         if (capacity_ > 0) {
-            data = allocator.allocate(capacity_);
-            for (std::size_t i = 0; i < size_; ++i) {
-                std::construct_at(data + i, other.data[i]);
+            data_ = allocator.allocate(capacity_);
+            try {
+                copy_elements(other.data_, size_, data_);
+            } catch (...) {
+                allocator.deallocate(data_, capacity_);
+                throw;
             }
         }
     }
 
     dynamic_array(dynamic_array&& other) noexcept
-        : allocator(std::move(other.allocator)), data(other.data), 
+        : allocator(std::move(other.allocator)), data_(other.data_), 
           capacity_(other.capacity_), size_(other.size_) {
-        other.data = nullptr;
+        other.data_ = nullptr;
         other.capacity_ = 0;
         other.size_ = 0;
     }
@@ -185,16 +904,14 @@ public:
         if (this != &other) {
             clear();
             if (capacity_ < other.size_) {
-                if (data) {
-                    allocator.deallocate(data, capacity_);
+                if (data_) {
+                    allocator.deallocate(data_, capacity_);
                 }
                 capacity_ = other.capacity_;
-                data = allocator.allocate(capacity_);
+                data_ = allocator.allocate(capacity_);
             }
+            copy_elements(other.data_, other.size_, data_);
             size_ = other.size_;
-            for (std::size_t i = 0; i < size_; ++i) {
-                std::construct_at(data + i, other.data[i]);
-            }
         }
         return *this;
     }
@@ -202,40 +919,59 @@ public:
     dynamic_array& operator=(dynamic_array&& other) noexcept {
         if (this != &other) {
             clear();
-            if (data) {
-                allocator.deallocate(data, capacity_);
+            if (data_) {
+                allocator.deallocate(data_, capacity_);
             }
-            data = other.data;
+            data_ = other.data_;
             capacity_ = other.capacity_;
             size_ = other.size_;
             allocator = std::move(other.allocator);
-            other.data = nullptr;
+            other.data_ = nullptr;
             other.capacity_ = 0;
             other.size_ = 0;
         }
         return *this;
     }
 
-    T& operator[](std::size_t index) { return data[index]; }
-    const T& operator[](std::size_t index) const { return data[index]; }
+    T& operator[](std::size_t index) { return data_[index]; }
+    const T& operator[](std::size_t index) const { return data_[index]; }
 
     T& at(std::size_t index) {
         if (index >= size_) throw std::out_of_range("Index out of range");
-        return data[index];
+        return data_[index];
     }
 
     const T& at(std::size_t index) const {
         if (index >= size_) throw std::out_of_range("Index out of range");
-        return data[index];
+        return data_[index];
     }
 
-    T& front() { return data[0]; }
-    const T& front() const { return data[0]; }
-    T& back() { return data[size_ - 1]; }
-    const T& back() const { return data[size_ - 1]; }
+    T& front() { return data_[0]; }
+    const T& front() const { return data_[0]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    allocator_type get_allocator() const { return allocator; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    operator std::span<T>() { return std::span<T>(data_, size_); }
+    operator std::span<const T>() const { return std::span<const T>(data_, size_); }
 
-    iterator begin() { return iterator(data); }
-    iterator end() { return iterator(data + size_); }
+    iterator begin() { return iterator(data_); }
+    iterator end() { return iterator(data_ + size_); }
+    const_iterator begin() const { return const_iterator(data_); }
+    const_iterator end() const { return const_iterator(data_ + size_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crbegin() const { return rbegin(); }
+    const_reverse_iterator crend() const { return rend(); }
 
     std::size_t size() const { return size_; }
     std::size_t capacity() const { return capacity_; }
@@ -243,67 +979,78 @@ public:
 
     void push_back(const T& value) {
         resize_if_needed();
-        std::construct_at(data + size_, value);
+        std::construct_at(data_ + size_, value);
         ++size_;
     }
 
     void push_back(T&& value) {
         resize_if_needed();
-        std::construct_at(data + size_, std::move(value));
+        std::construct_at(data_ + size_, std::move(value));
         ++size_;
     }
 
     template<typename... Args>
     void emplace_back(Args&&... args) {
         resize_if_needed();
-        std::construct_at(data + size_, std::forward<Args>(args)...);
+        std::construct_at(data_ + size_, std::forward<Args>(args)...);
         ++size_;
     }
 
     void pop_back() {
         if (size_ > 0) {
             --size_;
-            std::destroy_at(data + size_);
+            std::destroy_at(data_ + size_);
         }
     }
 
     void clear() {
-        for (std::size_t i = 0; i < size_; ++i) {
-            std::destroy_at(data + i);
-        }
+        destroy_elements(data_, size_);
         size_ = 0;
     }
 
+    // Makes room for at least new_capacity elements with one allocation,
+    // or none when the buffer can grow in place.
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        new_capacity = fit_capacity(new_capacity);
+        if (!expand_in_place(new_capacity)) {
+            relocate(new_capacity);
+        }
+    }
+
+    // Gives the unused capacity back to the memory resource, in place when
+    // the resource can trim the block. Nothing happens when the resource
+    // would hand out a block of the current size anyway.
+    void shrink_to_fit() {
+        if (size_ == capacity_) {
+            return;
+        }
+        if (size_ == 0) {
+            allocator.deallocate(data_, capacity_);
+            data_ = nullptr;
+            capacity_ = 0;
+            return;
+        }
+        std::size_t new_capacity = fit_capacity(size_);
+        if (new_capacity >= capacity_) {
+            return;
+        }
+        if (!expand_in_place(new_capacity)) {
+            relocate(new_capacity);
+        }
+    }
+
     void resize(std::size_t new_size) {
         if (new_size > capacity_) {
-            std::size_t new_capacity = std::max(capacity_ * 2, new_size);
-            T* new_data = allocator.allocate(new_capacity);
-            
-            for (std::size_t i = 0; i < size_; ++i) {
-                std::construct_at(new_data + i, std::move_if_noexcept(data[i]));
-                std::destroy_at(data + i);
-            }
-            
-            for (std::size_t i = size_; i < new_size; ++i) {
-                std::construct_at(new_data + i);
-            }
-            
-            if (data) {
-                allocator.deallocate(data, capacity_);
-            }
-            
-            data = new_data;
-            capacity_ = new_capacity;
-        } else if (new_size > size_) {
-            for (std::size_t i = size_; i < new_size; ++i) {
-                std::construct_at(data + i);
-            }
+            reserve(GrowthPolicy::next_capacity(capacity_, new_size, sizeof(T)));
+        }
+        if (new_size > size_) {
+            std::uninitialized_value_construct_n(data_ + size_, new_size - size_);
         } else if (new_size < size_) {
-            for (std::size_t i = new_size; i < size_; ++i) {
-                std::destroy_at(data + i);
-            }
+            destroy_elements(data_ + new_size, size_ - new_size);
         }
-        
         size_ = new_size;
     }
 };
@@ -0,0 +1,36 @@
+#pragma once
+#include <memory_resource>
+#include <cstddef>
+
+// Memory resource with two optional hooks that let containers avoid
+// needless relocations:
+//  - try_expand() resizes an allocation where it stands. Growing takes
+//    room from behind the block; shrinking may give the tail back. After a
+//    successful call the block must be deallocated with the new size.
+//  - good_size() reports how many bytes a request would really occupy, so
+//    a container can ask for capacity it would otherwise waste.
+// Containers probe both and behave as usual on any other resource.
+class expandable_memory_resource : public std::pmr::memory_resource {
+public:
+    bool try_expand(void* p, std::size_t old_bytes, std::size_t new_bytes) {
+        return do_try_expand(p, old_bytes, new_bytes);
+    }
+
+    std::size_t good_size(std::size_t bytes, std::size_t alignment) const {
+        return do_good_size(bytes, alignment);
+    }
+
+protected:
+    virtual bool do_try_expand(void*, std::size_t, std::size_t) { return false; }
+    virtual std::size_t do_good_size(std::size_t bytes, std::size_t) const { return bytes; }
+};
+
+inline bool try_expand(std::pmr::memory_resource* mr, void* p, std::size_t old_bytes, std::size_t new_bytes) {
+    auto* expandable = dynamic_cast<expandable_memory_resource*>(mr);
+    return expandable && expandable->try_expand(p, old_bytes, new_bytes);
+}
+
+inline std::size_t good_size(const std::pmr::memory_resource* mr, std::size_t bytes, std::size_t alignment) {
+    auto* expandable = dynamic_cast<const expandable_memory_resource*>(mr);
+    return expandable ? expandable->good_size(bytes, alignment) : bytes;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <memory_resource>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+
+// Places allocations of at least `threshold` bytes on 2 MiB pages. A
+// MAP_HUGETLB mapping is tried first so reserved huge pages are used when
+// the system has them; otherwise a 2 MiB-aligned anonymous mapping is
+// advised with MADV_HUGEPAGE for transparent huge pages. Smaller requests
+// go to the fallback resource.
+class huge_page_memory_resource : public std::pmr::memory_resource {
+private:
+    static constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+    std::pmr::memory_resource* fallback;
+    std::size_t threshold;
+    std::atomic<std::size_t> hugetlb_count{0};
+    std::atomic<std::size_t> transparent_count{0};
+
+    static std::size_t round_up(std::size_t n, std::size_t alignment) {
+        return (n + alignment - 1) & ~(alignment - 1);
+    }
+
+    bool is_large(std::size_t bytes, std::size_t alignment) const {
+        return bytes >= threshold || alignment > huge_page_size;
+    }
+
+    static std::size_t mapping_alignment(std::size_t alignment) {
+        return std::max(alignment, huge_page_size);
+    }
+
+    void* map_hugetlb(std::size_t length) {
+#ifdef MAP_HUGETLB
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            hugetlb_count.fetch_add(1, std::memory_order_relaxed);
+            return p;
+        }
+#else
+        (void)length;
+#endif
+        return nullptr;
+    }
+
+    void* map_transparent(std::size_t length, std::size_t alignment) {
+        std::size_t reserve = length + alignment;
+        void* raw = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(raw);
+        std::uintptr_t aligned = (begin + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+        std::uintptr_t end = begin + reserve;
+        if (aligned > begin) {
+            munmap(raw, aligned - begin);
+        }
+        if (end > aligned + length) {
+            munmap(reinterpret_cast<void*>(aligned + length), end - aligned - length);
+        }
+
+        void* p = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(p, length, MADV_HUGEPAGE);
+#endif
+        transparent_count.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+public:
+    explicit huge_page_memory_resource(std::pmr::memory_resource* fallback_mr = std::pmr::get_default_resource(),
+                                       std::size_t large_threshold = huge_page_size)
+        : fallback(fallback_mr), threshold(large_threshold) {}
+
+    huge_page_memory_resource(const huge_page_memory_resource&) = delete;
+    huge_page_memory_resource& operator=(const huge_page_memory_resource&) = delete;
+
+    std::pmr::memory_resource* upstream_resource() const { return fallback; }
+
+    std::size_t hugetlb_mappings() const { return hugetlb_count.load(std::memory_order_relaxed); }
+    std::size_t transparent_mappings() const { return transparent_count.load(std::memory_order_relaxed); }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!is_large(bytes, alignment)) {
+            return fallback->allocate(bytes, alignment);
+        }
+
+        std::size_t align = mapping_alignment(alignment);
+        std::size_t length = round_up(bytes, huge_page_size);
+        if (align == huge_page_size) {
+            if (void* p = map_hugetlb(length)) {
+                return p;
+            }
+        }
+        return map_transparent(length, align);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        if (!is_large(bytes, alignment)) {
+            fallback->deallocate(p, bytes, alignment);
+            return;
+        }
+        munmap(p, round_up(bytes, huge_page_size));
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
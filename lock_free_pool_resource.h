@@ -0,0 +1,181 @@
+#pragma once
+#include <memory_resource>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+// Fixed-size blocks per power-of-two size class, each class kept in a Treiber
+// stack. The stack head packs a 32-bit block index with a 32-bit generation
+// tag into one 64-bit word, so a stale compare-exchange after an ABA reuse
+// fails. Spans are aligned to span_bytes and start with their span number,
+// which turns a block pointer back into its index without any lookup.
+class lock_free_pool_resource : public std::pmr::memory_resource {
+private:
+    static constexpr std::size_t min_class_log2 = 4;
+    static constexpr std::size_t max_class_log2 = 12;
+    static constexpr std::size_t class_count = max_class_log2 - min_class_log2 + 1;
+    static constexpr std::size_t max_class_size = std::size_t(1) << max_class_log2;
+    static constexpr std::size_t span_bytes = 64 * 1024;
+    static constexpr std::size_t max_spans = 16384;
+    static constexpr std::uint32_t null_index = 0xffffffffu;
+
+    struct free_node {
+        std::atomic<std::uint32_t> next;
+    };
+
+    struct span_header {
+        std::uint32_t number;
+    };
+
+    struct size_class {
+        std::atomic<std::uint64_t> head{pack(null_index, 0)};
+        char** spans = nullptr;
+        std::uint32_t span_count = 0;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::mutex grow_mutex;
+    size_class classes[class_count];
+
+    static constexpr std::uint64_t pack(std::uint32_t index, std::uint32_t tag) {
+        return (std::uint64_t(tag) << 32) | index;
+    }
+    static std::uint32_t index_of(std::uint64_t head) { return static_cast<std::uint32_t>(head); }
+    static std::uint32_t tag_of(std::uint64_t head) { return static_cast<std::uint32_t>(head >> 32); }
+
+    static std::size_t class_size(std::size_t c) { return std::size_t(1) << (c + min_class_log2); }
+    static std::size_t blocks_per_span(std::size_t c) { return span_bytes / class_size(c); }
+
+    static std::size_t class_index(std::size_t size) {
+        if (size <= class_size(0)) {
+            return 0;
+        }
+        return std::bit_width(size - 1) - min_class_log2;
+    }
+
+    free_node* node_at(std::size_t c, std::uint32_t index) const {
+        std::size_t per_span = blocks_per_span(c);
+        char* span = classes[c].spans[index / per_span];
+        return reinterpret_cast<free_node*>(span + (index % per_span) * class_size(c));
+    }
+
+    static std::uint32_t index_from(std::size_t c, void* p) {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        std::uintptr_t base = address & ~(std::uintptr_t(span_bytes) - 1);
+        std::uint32_t number = reinterpret_cast<span_header*>(base)->number;
+        return static_cast<std::uint32_t>(number * blocks_per_span(c) + (address - base) / class_size(c));
+    }
+
+    void* pop(std::size_t c) {
+        size_class& cls = classes[c];
+        std::uint64_t head = cls.head.load(std::memory_order_acquire);
+        while (index_of(head) != null_index) {
+            free_node* node = node_at(c, index_of(head));
+            std::uint32_t next = node->next.load(std::memory_order_relaxed);
+            if (cls.head.compare_exchange_weak(head, pack(next, tag_of(head) + 1),
+                                               std::memory_order_acquire, std::memory_order_acquire)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    void push_chain(std::size_t c, std::uint32_t first, free_node* last) {
+        size_class& cls = classes[c];
+        std::uint64_t head = cls.head.load(std::memory_order_relaxed);
+        do {
+            last->next.store(index_of(head), std::memory_order_relaxed);
+        } while (!cls.head.compare_exchange_weak(head, pack(first, tag_of(head) + 1),
+                                                 std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void* grow(std::size_t c) {
+        std::lock_guard<std::mutex> lock(grow_mutex);
+        if (void* p = pop(c)) {
+            return p;
+        }
+
+        size_class& cls = classes[c];
+        if (!cls.spans) {
+            cls.spans = static_cast<char**>(upstream->allocate(max_spans * sizeof(char*), alignof(char*)));
+        }
+        if (cls.span_count == max_spans) {
+            throw std::bad_alloc();
+        }
+
+        char* span = static_cast<char*>(upstream->allocate(span_bytes, span_bytes));
+        std::uint32_t number = cls.span_count;
+        reinterpret_cast<span_header*>(span)->number = number;
+        cls.spans[number] = span;
+        ++cls.span_count;
+
+        std::size_t per_span = blocks_per_span(c);
+        std::size_t size = class_size(c);
+        std::uint32_t first_index = static_cast<std::uint32_t>(number * per_span);
+        for (std::size_t k = 2; k + 1 < per_span; ++k) {
+            free_node* node = new (span + k * size) free_node;
+            node->next.store(static_cast<std::uint32_t>(first_index + k + 1), std::memory_order_relaxed);
+        }
+        if (per_span > 2) {
+            free_node* last = new (span + (per_span - 1) * size) free_node;
+            push_chain(c, static_cast<std::uint32_t>(first_index + 2), last);
+        }
+        return span + size;
+    }
+
+public:
+    explicit lock_free_pool_resource(std::pmr::memory_resource* upstream_mr = std::pmr::get_default_resource())
+        : upstream(upstream_mr) {}
+
+    lock_free_pool_resource(const lock_free_pool_resource&) = delete;
+    lock_free_pool_resource& operator=(const lock_free_pool_resource&) = delete;
+
+    ~lock_free_pool_resource() override {
+        for (size_class& cls : classes) {
+            for (std::uint32_t i = 0; i < cls.span_count; ++i) {
+                upstream->deallocate(cls.spans[i], span_bytes, span_bytes);
+            }
+            if (cls.spans) {
+                upstream->deallocate(cls.spans, max_spans * sizeof(char*), alignof(char*));
+            }
+        }
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::size_t size = std::max(bytes, alignment);
+        if (size > max_class_size) {
+            std::lock_guard<std::mutex> lock(grow_mutex);
+            return upstream->allocate(bytes, alignment);
+        }
+
+        std::size_t c = class_index(size);
+        if (void* p = pop(c)) {
+            return p;
+        }
+        return grow(c);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::size_t size = std::max(bytes, alignment);
+        if (size > max_class_size) {
+            std::lock_guard<std::mutex> lock(grow_mutex);
+            upstream->deallocate(p, bytes, alignment);
+            return;
+        }
+
+        std::size_t c = class_index(size);
+        free_node* node = new (p) free_node;
+        push_chain(c, index_from(c, p), node);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
@@ -1,5 +1,9 @@
 #include "dynamic_array.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <span>
 #include <string>
 
 struct Person {
@@ -15,6 +19,30 @@ struct Person {
     }
 };
 
+struct alignas(32) Vec4 {
+    double x, y, z, w;
+
+    Vec4() : x(0.0), y(0.0), z(0.0), w(0.0) {}
+    Vec4(double x_, double y_, double z_, double w_) : x(x_), y(y_), z(z_), w(w_) {}
+};
+
+struct alignas(64) PaddedCounter {
+    long value;
+
+    PaddedCounter() : value(0) {}
+    explicit PaddedCounter(long v) : value(v) {}
+};
+
+template<typename T>
+bool all_aligned(dynamic_array<T>& arr) {
+    for (auto it = arr.begin(); it != arr.end(); ++it) {
+        if (reinterpret_cast<std::uintptr_t>(&*it) % alignof(T) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 int main() {
     dynamic_list_memory_resource mr;
     
@@ -46,5 +74,44 @@ int main() {
     ++it;
     std::cout << "Second person: " << *it << std::endl;
     
+    dynamic_array<Vec4> vectors(&mr);
+    dynamic_array<PaddedCounter> counters(&mr);
+    for (int i = 0; i < 100; ++i) {
+        vectors.emplace_back(i, i + 1.0, i + 2.0, i + 3.0);
+        counters.emplace_back(i);
+    }
+    
+    std::cout << "Vec4 elements 32-byte aligned: " << (all_aligned(vectors) ? "yes" : "no") << std::endl;
+    std::cout << "PaddedCounter elements 64-byte aligned: " << (all_aligned(counters) ? "yes" : "no") << std::endl;
+    
+    dynamic_array<int> reserved(&mr);
+    reserved.reserve(1000);
+    std::size_t reserved_capacity = reserved.capacity();
+    for (int i = 0; i < 600; ++i) {
+        reserved.push_back(i);
+    }
+    std::cout << "Reserved capacity: " << reserved_capacity
+              << ", unchanged after 600 push_backs: " << (reserved.capacity() == reserved_capacity ? "yes" : "no") << std::endl;
+    reserved.shrink_to_fit();
+    std::cout << "Capacity after shrink_to_fit: " << reserved.capacity() << std::endl;
+    
+    std::sort(int_arr.begin(), int_arr.end(), std::greater<int>());
+    std::span<const int> squares = int_arr;
+    std::cout << "Sorted descending, read back in reverse: ";
+    for (auto it = squares.rbegin(); it != squares.rend(); ++it) {
+        std::cout << *it << " ";
+    }
+    std::cout << std::endl;
+    
+    dynamic_list_memory_resource idle(std::pmr::get_default_resource(), 1 << 20);
+    void* burst = idle.allocate(900 << 10);
+    idle.deallocate(burst, 900 << 10);
+    std::size_t trimmed = idle.trim(512 << 10);
+    std::cout << "Trim keeping 512 KiB: returned " << trimmed << " bytes, idle chunk kept: "
+              << (trimmed == 0 && idle.chunk_count() == 1 ? "yes" : "no") << std::endl;
+    
+    std::cout << "Memory resource stats: " << mr.stats() << std::endl;
+    std::cout << "Memory resource stats JSON: " << mr.stats().to_json() << std::endl;
+    
     return 0;
 }
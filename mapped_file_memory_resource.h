@@ -0,0 +1,243 @@
+#pragma once
+#include "dynamic_array.h"
+#include "expandable_memory_resource.h"
+#include "offset_heap.h"
+#include <memory_resource>
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Memory resource whose storage is a memory-mapped file. All bookkeeping in
+// the file is kept as offsets from the start of the mapping, so the file can
+// be mapped at any address. One dynamic_array can be recorded as the root
+// with checkpoint() and handed back by load_root() after the file is
+// reopened, without parsing or copying.
+//
+// The mapping sits at the start of a reserved address range and grows in
+// place, so pointers held by live arrays stay valid while the file grows.
+class mapped_file_memory_resource : public expandable_memory_resource {
+private:
+    static constexpr std::uint64_t file_magic = 0x5041'4d44'5941'5252ULL;
+    static constexpr std::uint64_t file_version = 1;
+    static constexpr std::size_t default_initial_size = std::size_t(1) << 20;
+    static constexpr std::size_t default_reserve_size = std::size_t(1) << 36;
+
+    struct file_header {
+        std::uint64_t magic;
+        std::uint64_t version;
+        std::uint64_t file_size;
+        offset_heap::state heap;
+        std::uint64_t root_offset;
+        std::uint64_t root_size;
+        std::uint64_t root_capacity;
+        std::uint64_t root_element_size;
+    };
+
+    static constexpr std::size_t data_start = (sizeof(file_header) + 63) & ~std::size_t(63);
+
+    int fd = -1;
+    char* base = nullptr;
+    std::size_t reserve_size;
+    std::size_t page_size;
+    bool root_released = false;
+
+    static std::uint64_t round_up(std::uint64_t n, std::uint64_t alignment) {
+        return (n + alignment - 1) & ~(alignment - 1);
+    }
+
+    [[noreturn]] static void throw_errno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    file_header* header() const { return reinterpret_cast<file_header*>(base); }
+    offset_heap heap() const { return offset_heap(base, &header()->heap); }
+
+    // offset_heap's growth callback: reports a file that cannot grow as
+    // false, so try_expand() fails quietly and allocate() throws bad_alloc.
+    bool reserve(std::uint64_t end) {
+        if (end > reserve_size) {
+            return false;
+        }
+        if (end > header()->file_size) {
+            try {
+                grow(end);
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void map_range(std::size_t from, std::size_t to) {
+        void* p = mmap(base + from, to - from, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                       static_cast<off_t>(from));
+        if (p == MAP_FAILED) {
+            throw_errno("mmap");
+        }
+    }
+
+    void grow(std::uint64_t min_size) {
+        std::uint64_t old_size = header()->file_size;
+        std::uint64_t new_size = round_up(std::max<std::uint64_t>(min_size, std::min<std::uint64_t>(old_size * 2, reserve_size)), page_size);
+        if (new_size > reserve_size) {
+            throw std::bad_alloc();
+        }
+        if (ftruncate(fd, static_cast<off_t>(new_size)) != 0) {
+            throw_errno("ftruncate");
+        }
+        map_range(static_cast<std::size_t>(old_size), static_cast<std::size_t>(new_size));
+        header()->file_size = new_size;
+    }
+
+    void open_file(const std::string& path, std::size_t initial_size) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw_errno("open");
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            throw_errno("fstat");
+        }
+        std::size_t file_size = static_cast<std::size_t>(st.st_size);
+        bool fresh = file_size == 0;
+        if (fresh) {
+            file_size = static_cast<std::size_t>(round_up(std::max(initial_size, data_start), page_size));
+            if (ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+                throw_errno("ftruncate");
+            }
+        } else if (file_size < sizeof(file_header)) {
+            throw std::runtime_error("Mapped file is too small to hold a header");
+        }
+        if (file_size > reserve_size) {
+            throw std::runtime_error("Mapped file is larger than the reserved address range");
+        }
+
+        void* reserved = mmap(nullptr, reserve_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (reserved == MAP_FAILED) {
+            throw_errno("mmap");
+        }
+        base = static_cast<char*>(reserved);
+        map_range(0, file_size);
+
+        file_header* h = header();
+        if (fresh) {
+            *h = file_header{file_magic, file_version, file_size, offset_heap::initial_state(data_start), 0, 0, 0, 0};
+        } else if (h->magic != file_magic || h->version != file_version || h->file_size != file_size) {
+            throw std::runtime_error("File is not a mapped_file_memory_resource image");
+        }
+    }
+
+    void close_file() {
+        if (base) {
+            munmap(base, reserve_size);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    void set_root(const void* data, std::size_t size, std::size_t capacity, std::size_t element_size) {
+        file_header* h = header();
+        std::uint64_t offset = data ? static_cast<std::uint64_t>(static_cast<const char*>(data) - base) : 0;
+        if (h->root_offset && h->root_offset != offset && root_released) {
+            heap().deallocate(h->root_offset);
+        }
+        root_released = false;
+        h->root_offset = offset;
+        h->root_size = size;
+        h->root_capacity = capacity;
+        h->root_element_size = element_size;
+    }
+
+public:
+    explicit mapped_file_memory_resource(const std::string& path,
+                                         std::size_t initial_size = default_initial_size,
+                                         std::size_t reserve_bytes = default_reserve_size)
+        : reserve_size(reserve_bytes), page_size(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))) {
+        try {
+            open_file(path, initial_size);
+        } catch (...) {
+            close_file();
+            throw;
+        }
+    }
+
+    mapped_file_memory_resource(const mapped_file_memory_resource&) = delete;
+    mapped_file_memory_resource& operator=(const mapped_file_memory_resource&) = delete;
+
+    ~mapped_file_memory_resource() override {
+        close_file();
+    }
+
+    std::size_t file_size() const { return static_cast<std::size_t>(header()->file_size); }
+    bool has_root() const { return header()->root_offset != 0; }
+
+    void checkpoint() {
+        if (msync(base, file_size(), MS_SYNC) != 0) {
+            throw_errno("msync");
+        }
+    }
+
+    template<typename T, typename GrowthPolicy>
+    void checkpoint(dynamic_array<T, GrowthPolicy>& arr) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be persisted");
+        if (arr.get_allocator().resource() != this) {
+            throw std::invalid_argument("Only arrays allocated from this mapped file can be checkpointed");
+        }
+        set_root(arr.data(), arr.size(), arr.capacity(), sizeof(T));
+        checkpoint();
+    }
+
+    template<typename T, typename GrowthPolicy = doubling_growth>
+    dynamic_array<T, GrowthPolicy> load_root() {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be persisted");
+        file_header* h = header();
+        if (!h->root_offset) {
+            return dynamic_array<T, GrowthPolicy>(this);
+        }
+        if (h->root_element_size != sizeof(T) ||
+            h->root_capacity * sizeof(T) > heap().block_size(h->root_offset)) {
+            throw std::runtime_error("Root array does not match the requested element type");
+        }
+        T* storage = reinterpret_cast<T*>(base + h->root_offset);
+        return dynamic_array<T, GrowthPolicy>(adopt_storage, storage, static_cast<std::size_t>(h->root_size),
+                                              static_cast<std::size_t>(h->root_capacity), this);
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::uint64_t offset = heap().allocate(bytes, alignment, [this](std::uint64_t end) { return reserve(end); });
+        return base + offset;
+    }
+
+    void do_deallocate(void* p, std::size_t, std::size_t) override {
+        std::uint64_t offset = static_cast<std::uint64_t>(static_cast<char*>(p) - base);
+        if (offset == header()->root_offset) {
+            root_released = true;
+            return;
+        }
+        heap().deallocate(offset);
+    }
+
+    bool do_try_expand(void* p, std::size_t, std::size_t new_bytes) override {
+        std::uint64_t offset = static_cast<std::uint64_t>(static_cast<char*>(p) - base);
+        return heap().try_expand(offset, new_bytes, [this](std::uint64_t end) { return reserve(end); });
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
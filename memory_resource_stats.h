@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+struct memory_resource_stats {
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t bytes_live = 0;
+    std::size_t bytes_high_water = 0;
+    std::size_t upstream_bytes = 0;
+    std::size_t upstream_chunks = 0;
+    std::size_t bytes_trimmed = 0;
+    std::size_t free_blocks = 0;
+    std::size_t search_steps = 0;
+    std::size_t splits = 0;
+    std::size_t merges = 0;
+    double fragmentation = 0.0;
+
+    double average_search_steps() const {
+        return allocations == 0 ? 0.0 : static_cast<double>(search_steps) / static_cast<double>(allocations);
+    }
+
+    std::string to_json() const {
+        std::ostringstream os;
+        os << "{\"allocations\":" << allocations
+           << ",\"deallocations\":" << deallocations
+           << ",\"bytes_live\":" << bytes_live
+           << ",\"bytes_high_water\":" << bytes_high_water
+           << ",\"upstream_bytes\":" << upstream_bytes
+           << ",\"upstream_chunks\":" << upstream_chunks
+           << ",\"bytes_trimmed\":" << bytes_trimmed
+           << ",\"free_blocks\":" << free_blocks
+           << ",\"average_search_steps\":" << average_search_steps()
+           << ",\"splits\":" << splits
+           << ",\"merges\":" << merges
+           << ",\"fragmentation\":" << fragmentation << "}";
+        return os.str();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const memory_resource_stats& s) {
+        return os << "allocations: " << s.allocations
+                  << ", deallocations: " << s.deallocations
+                  << ", bytes live: " << s.bytes_live
+                  << ", high water: " << s.bytes_high_water
+                  << ", upstream bytes: " << s.upstream_bytes
+                  << ", upstream chunks: " << s.upstream_chunks
+                  << ", bytes trimmed: " << s.bytes_trimmed
+                  << ", free blocks: " << s.free_blocks
+                  << ", average search steps: " << s.average_search_steps()
+                  << ", splits: " << s.splits
+                  << ", merges: " << s.merges
+                  << ", fragmentation: " << s.fragmentation;
+    }
+};
@@ -0,0 +1,193 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// First-fit heap whose bookkeeping lives inside the region it manages. Every
+// link is an offset from the region base, so the region can be mapped at a
+// different address by every process or run. Free blocks are kept in address
+// order and coalesced; freeing the last block moves the bump pointer back.
+class offset_heap {
+public:
+    struct state {
+        std::uint64_t used;
+        std::uint64_t free_head;
+    };
+
+    static constexpr std::size_t min_alignment = 16;
+
+private:
+    struct block_header {
+        std::uint64_t size;
+        std::uint64_t next_free;
+    };
+
+    static constexpr std::size_t header_size = sizeof(block_header);
+
+    char* base;
+    state* heap;
+
+    static std::uint64_t round_up(std::uint64_t n, std::uint64_t alignment) {
+        return (n + alignment - 1) & ~(alignment - 1);
+    }
+
+    block_header* block(std::uint64_t offset) const { return reinterpret_cast<block_header*>(base + offset); }
+
+    void release_block(std::uint64_t offset) {
+        std::uint64_t prev = 0;
+        std::uint64_t cur = heap->free_head;
+        while (cur && cur < offset) {
+            prev = cur;
+            cur = block(cur)->next_free;
+        }
+
+        block(offset)->next_free = cur;
+        if (prev) {
+            block(prev)->next_free = offset;
+        } else {
+            heap->free_head = offset;
+        }
+
+        if (cur && offset + header_size + block(offset)->size == cur) {
+            block(offset)->size += header_size + block(cur)->size;
+            block(offset)->next_free = block(cur)->next_free;
+        }
+        if (prev && prev + header_size + block(prev)->size == offset) {
+            block(prev)->size += header_size + block(offset)->size;
+            block(prev)->next_free = block(offset)->next_free;
+            offset = prev;
+        }
+
+        if (offset + header_size + block(offset)->size == heap->used && block(offset)->next_free == 0) {
+            if (heap->free_head == offset) {
+                heap->free_head = 0;
+            } else {
+                std::uint64_t before = heap->free_head;
+                while (block(before)->next_free != offset) {
+                    before = block(before)->next_free;
+                }
+                block(before)->next_free = 0;
+            }
+            heap->used = offset;
+        }
+    }
+
+public:
+    offset_heap(char* region_base, state* heap_state) : base(region_base), heap(heap_state) {}
+
+    // Empty heap state whose bump pointer starts at `data_start`.
+    static state initial_state(std::uint64_t data_start) {
+        return state{round_up(data_start, min_alignment), 0};
+    }
+
+    // Returns the offset of the allocated memory. `reserve(end)` is called
+    // before the bump pointer moves, must make [0, end) usable and returns
+    // false when the region cannot grow that far.
+    template<typename Reserve>
+    std::uint64_t allocate(std::uint64_t bytes, std::uint64_t alignment, Reserve&& reserve) {
+        std::uint64_t size = round_up(std::max<std::uint64_t>(bytes, min_alignment), min_alignment);
+        alignment = std::max<std::uint64_t>(alignment, min_alignment);
+
+        std::uint64_t prev = 0;
+        for (std::uint64_t cur = heap->free_head; cur; prev = cur, cur = block(cur)->next_free) {
+            block_header* b = block(cur);
+            if ((cur + header_size) % alignment != 0 || b->size < size) {
+                continue;
+            }
+            std::uint64_t next = b->next_free;
+            if (b->size >= size + header_size + min_alignment) {
+                std::uint64_t rest = cur + header_size + size;
+                block(rest)->size = b->size - size - header_size;
+                block(rest)->next_free = next;
+                next = rest;
+                b->size = size;
+            }
+            if (prev) {
+                block(prev)->next_free = next;
+            } else {
+                heap->free_head = next;
+            }
+            return cur + header_size;
+        }
+
+        std::uint64_t offset = round_up(heap->used + header_size, alignment) - header_size;
+        std::uint64_t end = offset + header_size + size;
+        if (!reserve(end)) {
+            throw std::bad_alloc();
+        }
+        std::uint64_t gap_start = heap->used;
+        block(offset)->size = size;
+        heap->used = end;
+        if (offset - gap_start >= header_size + min_alignment) {
+            block(gap_start)->size = offset - gap_start - header_size;
+            release_block(gap_start);
+        }
+        return offset + header_size;
+    }
+
+    // Grows the block at `offset` to at least `bytes` without moving it,
+    // either by taking the free block that follows it or, for the last
+    // block, by moving the bump pointer. A smaller `bytes` frees the tail.
+    template<typename Reserve>
+    bool try_expand(std::uint64_t offset, std::uint64_t bytes, Reserve&& reserve) {
+        block_header* b = block(offset - header_size);
+        std::uint64_t size = round_up(std::max<std::uint64_t>(bytes, min_alignment), min_alignment);
+        if (size <= b->size) {
+            if (b->size >= size + header_size + min_alignment) {
+                std::uint64_t rest = offset + size;
+                block(rest)->size = b->size - size - header_size;
+                b->size = size;
+                release_block(rest);
+            }
+            return true;
+        }
+
+        std::uint64_t next = offset + b->size;
+        if (next == heap->used) {
+            if (!reserve(offset + size)) {
+                return false;
+            }
+            b->size = size;
+            heap->used = offset + size;
+            return true;
+        }
+
+        std::uint64_t prev = 0;
+        std::uint64_t cur = heap->free_head;
+        while (cur && cur < next) {
+            prev = cur;
+            cur = block(cur)->next_free;
+        }
+        if (cur != next || b->size + header_size + block(cur)->size < size) {
+            return false;
+        }
+
+        std::uint64_t after = block(cur)->next_free;
+        std::uint64_t total = b->size + header_size + block(cur)->size;
+        if (total >= size + header_size + min_alignment) {
+            std::uint64_t rest = offset + size;
+            block(rest)->size = total - size - header_size;
+            block(rest)->next_free = after;
+            after = rest;
+            b->size = size;
+        } else {
+            b->size = total;
+        }
+        if (prev) {
+            block(prev)->next_free = after;
+        } else {
+            heap->free_head = after;
+        }
+        return true;
+    }
+
+    void deallocate(std::uint64_t offset) {
+        release_block(offset - header_size);
+    }
+
+    // Usable bytes of the block at `offset`.
+    std::uint64_t block_size(std::uint64_t offset) const {
+        return block(offset - header_size)->size;
+    }
+};
@@ -0,0 +1,332 @@
+#pragma once
+#include "expandable_memory_resource.h"
+#include "offset_heap.h"
+#include <memory_resource>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Memory resource over a POSIX shared memory object. The creating process
+// sizes the segment once (tmpfs only backs the pages that are touched) and
+// never remaps it, so its pointers stay valid. Other processes open the same
+// name read-only, map it at their own address and reach its contents through
+// offsets from the segment base. Only the creating process allocates.
+class shared_memory_resource : public expandable_memory_resource {
+public:
+    enum open_mode { create, open_read_only };
+
+private:
+    static constexpr std::uint64_t segment_magic = 0x4d48'5359'4152'5241ULL;
+    static constexpr std::uint64_t segment_version = 1;
+    static constexpr std::size_t default_segment_size = std::size_t(64) << 20;
+
+    struct segment_header {
+        std::atomic<std::uint64_t> magic;
+        std::uint64_t version;
+        std::uint64_t segment_size;
+        offset_heap::state heap;
+        std::atomic<std::uint64_t> root_offset;
+    };
+
+    static constexpr std::size_t data_start = (sizeof(segment_header) + 63) & ~std::size_t(63);
+
+    int fd = -1;
+    char* base = nullptr;
+    std::size_t size = 0;
+    bool writable;
+
+    [[noreturn]] static void throw_errno(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    segment_header* header() const { return reinterpret_cast<segment_header*>(base); }
+    offset_heap heap() const { return offset_heap(base, &header()->heap); }
+
+    void map_segment(const std::string& name, std::size_t segment_bytes) {
+        if (writable) {
+            fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+            if (fd < 0) {
+                throw_errno("shm_open");
+            }
+            size = std::max(segment_bytes, data_start);
+            if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+                throw_errno("ftruncate");
+            }
+        } else {
+            fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0) {
+                throw_errno("shm_open");
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                throw_errno("fstat");
+            }
+            size = static_cast<std::size_t>(st.st_size);
+            if (size < data_start) {
+                throw std::runtime_error("Shared memory segment is too small to hold a header");
+            }
+        }
+
+        int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* p = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            throw_errno("mmap");
+        }
+        base = static_cast<char*>(p);
+
+        if (writable) {
+            segment_header* h = new (base) segment_header{0, segment_version, size,
+                                                          offset_heap::initial_state(data_start), 0};
+            h->magic.store(segment_magic, std::memory_order_release);
+            return;
+        }
+        segment_header* h = header();
+        if (h->magic.load(std::memory_order_acquire) != segment_magic ||
+            h->version != segment_version || h->segment_size != size) {
+            throw std::runtime_error("Shared memory object is not an initialised shared_memory_resource segment");
+        }
+    }
+
+    void unmap_segment() {
+        if (base) {
+            munmap(base, size);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+public:
+    explicit shared_memory_resource(const std::string& name, open_mode mode = open_read_only,
+                                    std::size_t segment_bytes = default_segment_size)
+        : writable(mode == create) {
+        try {
+            map_segment(name, segment_bytes);
+        } catch (...) {
+            unmap_segment();
+            throw;
+        }
+    }
+
+    shared_memory_resource(const shared_memory_resource&) = delete;
+    shared_memory_resource& operator=(const shared_memory_resource&) = delete;
+
+    // Unmaps the segment; the shared memory object itself stays until
+    // remove() is called.
+    ~shared_memory_resource() override {
+        unmap_segment();
+    }
+
+    static void remove(const std::string& name) {
+        shm_unlink(name.c_str());
+    }
+
+    bool is_writable() const { return writable; }
+    std::size_t segment_size() const { return size; }
+
+    std::uint64_t offset_of(const void* p) const {
+        return static_cast<std::uint64_t>(static_cast<const char*>(p) - base);
+    }
+
+    char* address_of(std::uint64_t offset) const { return base + offset; }
+
+    std::uint64_t root_offset() const { return header()->root_offset.load(std::memory_order_acquire); }
+
+    void set_root_offset(std::uint64_t offset) {
+        header()->root_offset.store(offset, std::memory_order_release);
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (!writable) {
+            throw std::logic_error("Shared memory segment is opened read-only");
+        }
+        std::uint64_t offset = heap().allocate(bytes, alignment, [this](std::uint64_t end) { return end <= size; });
+        return base + offset;
+    }
+
+    void do_deallocate(void* p, std::size_t, std::size_t) override {
+        if (!writable) {
+            throw std::logic_error("Shared memory segment is opened read-only");
+        }
+        heap().deallocate(offset_of(p));
+    }
+
+    bool do_try_expand(void* p, std::size_t, std::size_t new_bytes) override {
+        return writable && heap().try_expand(offset_of(p), new_bytes, [this](std::uint64_t end) { return end <= size; });
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// dynamic_array flavour whose state lives inside a shared_memory_resource
+// segment and refers to its elements by offset, so every process that maps
+// the segment sees the same array. The creating process appends; other
+// processes read in place through read() / try_read().
+//
+// Appends only publish the new size. Anything that moves or overwrites
+// existing elements (growth, pop_back, clear) runs inside a seqlock: the
+// sequence is odd while the change is in progress, and a reader whose
+// sequence changed across its read discards what it saw.
+template<typename T>
+class offset_dynamic_array {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be shared");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "Shared counters must be lock-free to work across processes");
+
+private:
+    struct shared_state {
+        std::atomic<std::uint64_t> sequence;
+        std::atomic<std::uint64_t> data_offset;
+        std::atomic<std::uint64_t> size;
+        std::atomic<std::uint64_t> capacity;
+        std::uint64_t element_size;
+    };
+
+    shared_memory_resource* resource;
+    shared_state* state;
+
+    T* data_at(std::uint64_t offset) const { return reinterpret_cast<T*>(resource->address_of(offset)); }
+
+    void begin_write() {
+        state->sequence.store(state->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void end_write() {
+        state->sequence.store(state->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void relocate(std::size_t new_capacity) {
+        std::uint64_t old_offset = state->data_offset.load(std::memory_order_relaxed);
+        std::size_t old_capacity = capacity();
+        std::size_t count = size();
+
+        // Growing in place leaves every element where readers expect it, so
+        // only the capacity changes and no seqlock section is needed.
+        if (old_offset && resource->try_expand(data_at(old_offset), old_capacity * sizeof(T), new_capacity * sizeof(T))) {
+            state->capacity.store(new_capacity, std::memory_order_release);
+            return;
+        }
+
+        T* new_data = static_cast<T*>(resource->allocate(new_capacity * sizeof(T), alignof(T)));
+        if (count) {
+            std::memcpy(new_data, data_at(old_offset), count * sizeof(T));
+        }
+
+        begin_write();
+        state->data_offset.store(resource->offset_of(new_data), std::memory_order_relaxed);
+        state->capacity.store(new_capacity, std::memory_order_relaxed);
+        end_write();
+
+        if (old_offset) {
+            resource->deallocate(data_at(old_offset), old_capacity * sizeof(T), alignof(T));
+        }
+    }
+
+public:
+    // The creating process builds the array as the segment root on first
+    // use; readers attach to that root and throw if it is not there yet.
+    explicit offset_dynamic_array(shared_memory_resource& mr) : resource(&mr) {
+        std::uint64_t root = mr.root_offset();
+        if (root) {
+            state = reinterpret_cast<shared_state*>(mr.address_of(root));
+            if (state->element_size != sizeof(T)) {
+                throw std::runtime_error("Shared array does not match the requested element type");
+            }
+            return;
+        }
+        if (!mr.is_writable()) {
+            throw std::runtime_error("Shared memory segment has no array yet");
+        }
+
+        state = new (mr.allocate(sizeof(shared_state), alignof(shared_state))) shared_state{0, 0, 0, 0, sizeof(T)};
+        mr.set_root_offset(mr.offset_of(state));
+    }
+
+    std::size_t size() const { return static_cast<std::size_t>(state->size.load(std::memory_order_acquire)); }
+    std::size_t capacity() const { return static_cast<std::size_t>(state->capacity.load(std::memory_order_acquire)); }
+    bool empty() const { return size() == 0; }
+
+    // Number of completed layout changes. Readers can compare generations to
+    // notice that the buffer moved or shrank since they last looked.
+    std::uint64_t generation() const { return state->sequence.load(std::memory_order_acquire) / 2; }
+
+    // Writer side only; readers go through read() / try_read().
+    const T& operator[](std::size_t index) const {
+        return data_at(state->data_offset.load(std::memory_order_relaxed))[index];
+    }
+
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity > capacity()) {
+            relocate(new_capacity);
+        }
+    }
+
+    void push_back(const T& value) {
+        std::size_t count = size();
+        if (count == capacity()) {
+            relocate(count == 0 ? 4 : count * 2);
+        }
+        std::memcpy(data_at(state->data_offset.load(std::memory_order_relaxed)) + count, &value, sizeof(T));
+        state->size.store(count + 1, std::memory_order_release);
+    }
+
+    void pop_back() {
+        std::size_t count = size();
+        if (count > 0) {
+            begin_write();
+            state->size.store(count - 1, std::memory_order_relaxed);
+            end_write();
+        }
+    }
+
+    void clear() {
+        begin_write();
+        state->size.store(0, std::memory_order_relaxed);
+        end_write();
+    }
+
+    // Calls `f` with a view of the elements as seen in this process' mapping
+    // and returns whether the writer left the layout alone meanwhile. When it
+    // returns false, whatever `f` observed may be torn and must be discarded.
+    template<typename F>
+    bool try_read(F&& f) const {
+        std::uint64_t before = state->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        std::uint64_t offset = state->data_offset.load(std::memory_order_relaxed);
+        std::uint64_t count = state->size.load(std::memory_order_acquire);
+        if (offset + count * sizeof(T) > resource->segment_size() || (count && !offset)) {
+            return false;
+        }
+        f(std::span<const T>(data_at(offset), static_cast<std::size_t>(count)));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return state->sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Retries try_read() until `f` has run against a consistent view.
+    template<typename F>
+    void read(F&& f) const {
+        while (!try_read(f)) {
+        }
+    }
+};
@@ -0,0 +1,252 @@
+#pragma once
+#include "expandable_memory_resource.h"
+#include <memory_resource>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Small-object allocator with one set of slabs per size class. A slab is a
+// slab_bytes region aligned to its own size with its header at the end, so
+// a block pointer finds its slab by masking and blocks start at offset
+// zero, which keeps power-of-two classes naturally aligned. Blocks are
+// carved from a slab lazily and recycled through an in-slab free list.
+// Every slab counts its live blocks and sits on its class's partial or full
+// list; a slab that empties is kept as the class's spare if there is none
+// yet and returned upstream otherwise.
+class slab_memory_resource : public expandable_memory_resource {
+private:
+    static constexpr std::size_t class_sizes[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+    static constexpr std::size_t class_count = sizeof(class_sizes) / sizeof(class_sizes[0]);
+    static constexpr std::size_t max_class_size = class_sizes[class_count - 1];
+    static constexpr std::size_t min_alignment = 16;
+    static constexpr std::size_t default_slab_size = 64 * 1024;
+
+    struct free_block {
+        free_block* next;
+    };
+
+    struct slab_header {
+        slab_header* next;
+        slab_header* prev;
+        free_block* free_list;
+        std::uint32_t carved;
+        std::uint32_t used;
+    };
+
+    struct size_class {
+        slab_header* partial = nullptr;
+        slab_header* full = nullptr;
+        slab_header* spare = nullptr;
+        std::uint32_t blocks_per_slab = 0;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::size_t slab_bytes;
+    size_class classes[class_count];
+    std::size_t slabs = 0;
+
+    static bool is_power_of_two(std::size_t n) { return (n & (n - 1)) == 0; }
+
+    // Returns class_count when the request goes upstream.
+    static std::size_t class_index(std::size_t bytes, std::size_t alignment) {
+        if (alignment <= min_alignment) {
+            for (std::size_t c = 0; c < class_count; ++c) {
+                if (class_sizes[c] >= bytes) {
+                    return c;
+                }
+            }
+            return class_count;
+        }
+        std::size_t size = std::max(bytes, alignment);
+        for (std::size_t c = 0; c < class_count; ++c) {
+            if (class_sizes[c] >= size && is_power_of_two(class_sizes[c])) {
+                return c;
+            }
+        }
+        return class_count;
+    }
+
+    slab_header* header_of(char* slab) const {
+        return reinterpret_cast<slab_header*>(slab + slab_bytes - sizeof(slab_header));
+    }
+
+    char* slab_of(void* p) const {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<char*>(address & ~(std::uintptr_t(slab_bytes) - 1));
+    }
+
+    char* slab_of(slab_header* header) const {
+        return reinterpret_cast<char*>(header) + sizeof(slab_header) - slab_bytes;
+    }
+
+    static void push(slab_header*& list, slab_header* slab) {
+        slab->prev = nullptr;
+        slab->next = list;
+        if (list) {
+            list->prev = slab;
+        }
+        list = slab;
+    }
+
+    static void unlink(slab_header*& list, slab_header* slab) {
+        if (slab->next) {
+            slab->next->prev = slab->prev;
+        }
+        if (slab->prev) {
+            slab->prev->next = slab->next;
+        } else {
+            list = slab->next;
+        }
+    }
+
+    slab_header* new_slab(size_class& cls) {
+        if (slab_header* spare = cls.spare) {
+            cls.spare = nullptr;
+            return spare;
+        }
+        char* slab = static_cast<char*>(upstream->allocate(slab_bytes, slab_bytes));
+        ++slabs;
+        slab_header* header = header_of(slab);
+        header->free_list = nullptr;
+        header->carved = 0;
+        header->used = 0;
+        return header;
+    }
+
+    void release_slab(slab_header* header) {
+        upstream->deallocate(slab_of(header), slab_bytes, slab_bytes);
+        --slabs;
+    }
+
+    void release_list(slab_header* header) {
+        while (header) {
+            slab_header* next = header->next;
+            release_slab(header);
+            header = next;
+        }
+    }
+
+    void release_all() {
+        for (size_class& cls : classes) {
+            release_list(cls.partial);
+            release_list(cls.full);
+            cls.partial = nullptr;
+            cls.full = nullptr;
+            if (cls.spare) {
+                release_slab(cls.spare);
+                cls.spare = nullptr;
+            }
+        }
+    }
+
+public:
+    slab_memory_resource() : slab_memory_resource(std::pmr::get_default_resource()) {}
+
+    explicit slab_memory_resource(std::pmr::memory_resource* upstream_mr,
+                                  std::size_t slab_size = default_slab_size)
+        : upstream(upstream_mr) {
+        std::size_t min_slab = std::size_t(1) << 12;
+        slab_bytes = min_slab;
+        while (slab_bytes < slab_size || slab_bytes < 4 * max_class_size + sizeof(slab_header)) {
+            slab_bytes *= 2;
+        }
+        for (std::size_t c = 0; c < class_count; ++c) {
+            classes[c].blocks_per_slab =
+                static_cast<std::uint32_t>((slab_bytes - sizeof(slab_header)) / class_sizes[c]);
+        }
+    }
+
+    slab_memory_resource(const slab_memory_resource&) = delete;
+    slab_memory_resource& operator=(const slab_memory_resource&) = delete;
+
+    ~slab_memory_resource() override {
+        release_all();
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream; }
+
+    std::size_t slab_size() const { return slab_bytes; }
+    std::size_t slab_count() const { return slabs; }
+
+    // Returns the spare empty slab of every class to upstream and reports
+    // the number of bytes given back.
+    std::size_t trim() {
+        std::size_t returned = 0;
+        for (size_class& cls : classes) {
+            if (cls.spare) {
+                release_slab(cls.spare);
+                cls.spare = nullptr;
+                returned += slab_bytes;
+            }
+        }
+        return returned;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::size_t c = class_index(bytes, alignment);
+        if (c == class_count) {
+            return upstream->allocate(bytes, alignment);
+        }
+
+        size_class& cls = classes[c];
+        slab_header* slab = cls.partial;
+        if (!slab) {
+            slab = new_slab(cls);
+            push(cls.partial, slab);
+        }
+
+        void* p;
+        if (slab->free_list) {
+            p = slab->free_list;
+            slab->free_list = slab->free_list->next;
+        } else {
+            p = slab_of(slab) + std::size_t(slab->carved) * class_sizes[c];
+            ++slab->carved;
+        }
+        if (++slab->used == cls.blocks_per_slab) {
+            unlink(cls.partial, slab);
+            push(cls.full, slab);
+        }
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::size_t c = class_index(bytes, alignment);
+        if (c == class_count) {
+            upstream->deallocate(p, bytes, alignment);
+            return;
+        }
+
+        size_class& cls = classes[c];
+        slab_header* slab = header_of(slab_of(p));
+        free_block* block = static_cast<free_block*>(p);
+        block->next = slab->free_list;
+        slab->free_list = block;
+
+        if (slab->used-- == cls.blocks_per_slab) {
+            unlink(cls.full, slab);
+            push(cls.partial, slab);
+        }
+        if (slab->used == 0) {
+            unlink(cls.partial, slab);
+            slab->free_list = nullptr;
+            slab->carved = 0;
+            if (cls.spare) {
+                release_slab(slab);
+            } else {
+                cls.spare = slab;
+            }
+        }
+    }
+
+    std::size_t do_good_size(std::size_t bytes, std::size_t alignment) const override {
+        std::size_t c = class_index(bytes, alignment);
+        return c == class_count ? bytes : class_sizes[c];
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
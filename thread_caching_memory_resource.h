@@ -0,0 +1,247 @@
+#pragma once
+#include <memory_resource>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class thread_caching_memory_resource : public std::pmr::memory_resource {
+private:
+    static constexpr std::size_t min_class_log2 = 4;
+    static constexpr std::size_t max_class_log2 = 15;
+    static constexpr std::size_t class_count = max_class_log2 - min_class_log2 + 1;
+    static constexpr std::size_t max_class_size = std::size_t(1) << max_class_log2;
+    static constexpr std::size_t span_bytes = 64 * 1024;
+
+    struct free_node {
+        free_node* next;
+    };
+
+    struct size_class {
+        std::mutex mutex;
+        free_node* head = nullptr;
+    };
+
+    struct span_info {
+        void* ptr;
+        std::size_t size;
+        std::size_t alignment;
+    };
+
+    struct central_pool {
+        std::pmr::memory_resource* upstream;
+        std::mutex upstream_mutex;
+        std::vector<span_info> spans;
+        size_class classes[class_count];
+
+        explicit central_pool(std::pmr::memory_resource* mr) : upstream(mr) {}
+
+        ~central_pool() {
+            for (const auto& span : spans) {
+                upstream->deallocate(span.ptr, span.size, span.alignment);
+            }
+        }
+
+        void* allocate_large(std::size_t bytes, std::size_t alignment) {
+            std::lock_guard<std::mutex> lock(upstream_mutex);
+            return upstream->allocate(bytes, alignment);
+        }
+
+        void deallocate_large(void* p, std::size_t bytes, std::size_t alignment) {
+            std::lock_guard<std::mutex> lock(upstream_mutex);
+            upstream->deallocate(p, bytes, alignment);
+        }
+
+        free_node* carve_span(std::size_t index) {
+            std::size_t block_size = class_size(index);
+            std::size_t count = std::max<std::size_t>(span_bytes / block_size, 4);
+            std::size_t bytes = block_size * count;
+
+            char* memory;
+            {
+                std::lock_guard<std::mutex> lock(upstream_mutex);
+                memory = static_cast<char*>(upstream->allocate(bytes, block_size));
+                try {
+                    spans.push_back({memory, bytes, block_size});
+                } catch (...) {
+                    upstream->deallocate(memory, bytes, block_size);
+                    throw;
+                }
+            }
+
+            free_node* head = nullptr;
+            for (std::size_t i = count; i-- > 0;) {
+                free_node* node = reinterpret_cast<free_node*>(memory + i * block_size);
+                node->next = head;
+                head = node;
+            }
+            return head;
+        }
+    };
+
+    struct thread_cache {
+        struct bin {
+            free_node* head = nullptr;
+            std::size_t count = 0;
+        };
+
+        std::weak_ptr<central_pool> owner;
+        bin bins[class_count];
+    };
+
+    struct thread_registry {
+        std::unordered_map<std::uint64_t, thread_cache> caches;
+        std::uint64_t last_id = 0;
+        thread_cache* last_cache = nullptr;
+
+        ~thread_registry() {
+            for (auto& [id, cache] : caches) {
+                if (auto pool = cache.owner.lock()) {
+                    for (std::size_t index = 0; index < class_count; ++index) {
+                        release(*pool, cache.bins[index], index, cache.bins[index].count);
+                    }
+                }
+            }
+        }
+    };
+
+    std::shared_ptr<central_pool> pool;
+    std::uint64_t id;
+
+    static std::size_t class_size(std::size_t index) { return std::size_t(1) << (index + min_class_log2); }
+
+    static std::size_t class_index(std::size_t size) {
+        if (size <= class_size(0)) {
+            return 0;
+        }
+        return std::bit_width(size - 1) - min_class_log2;
+    }
+
+    static std::size_t batch_size(std::size_t index) {
+        return std::clamp<std::size_t>(8192 / class_size(index), 2, 64);
+    }
+
+    static std::uint64_t next_id() {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    static thread_registry& registry() {
+        thread_local thread_registry instance;
+        return instance;
+    }
+
+    static void release(central_pool& central, thread_cache::bin& bin, std::size_t index, std::size_t count) {
+        if (count == 0 || !bin.head) {
+            return;
+        }
+        free_node* first = bin.head;
+        free_node* last = first;
+        for (std::size_t i = 1; i < count && last->next; ++i) {
+            last = last->next;
+        }
+        bin.head = last->next;
+        bin.count -= std::min(count, bin.count);
+
+        size_class& target = central.classes[index];
+        std::lock_guard<std::mutex> lock(target.mutex);
+        last->next = target.head;
+        target.head = first;
+    }
+
+    void refill(thread_cache::bin& bin, std::size_t index) {
+        size_class& source = pool->classes[index];
+        std::size_t batch = batch_size(index);
+
+        std::lock_guard<std::mutex> lock(source.mutex);
+        if (!source.head) {
+            source.head = pool->carve_span(index);
+        }
+        free_node* first = source.head;
+        free_node* last = first;
+        std::size_t taken = 1;
+        while (taken < batch && last->next) {
+            last = last->next;
+            ++taken;
+        }
+        source.head = last->next;
+        last->next = bin.head;
+        bin.head = first;
+        bin.count += taken;
+    }
+
+    thread_cache& local_cache() {
+        thread_registry& r = registry();
+        if (r.last_id == id) {
+            return *r.last_cache;
+        }
+
+        auto it = r.caches.find(id);
+        if (it == r.caches.end()) {
+            std::erase_if(r.caches, [](const auto& entry) { return entry.second.owner.expired(); });
+            it = r.caches.emplace(id, thread_cache{}).first;
+            it->second.owner = pool;
+        }
+        r.last_id = id;
+        r.last_cache = &it->second;
+        return it->second;
+    }
+
+public:
+    explicit thread_caching_memory_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : pool(std::make_shared<central_pool>(upstream)), id(next_id()) {}
+
+    thread_caching_memory_resource(const thread_caching_memory_resource&) = delete;
+    thread_caching_memory_resource& operator=(const thread_caching_memory_resource&) = delete;
+
+    ~thread_caching_memory_resource() override = default;
+
+    std::pmr::memory_resource* upstream_resource() const { return pool->upstream; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        std::size_t size = std::max(bytes, alignment);
+        if (size > max_class_size) {
+            return pool->allocate_large(bytes, alignment);
+        }
+
+        std::size_t index = class_index(size);
+        thread_cache::bin& bin = local_cache().bins[index];
+        if (!bin.head) {
+            refill(bin, index);
+        }
+        free_node* node = bin.head;
+        bin.head = node->next;
+        --bin.count;
+        return node;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::size_t size = std::max(bytes, alignment);
+        if (size > max_class_size) {
+            pool->deallocate_large(p, bytes, alignment);
+            return;
+        }
+
+        std::size_t index = class_index(size);
+        thread_cache::bin& bin = local_cache().bins[index];
+        free_node* node = static_cast<free_node*>(p);
+        node->next = bin.head;
+        bin.head = node;
+        ++bin.count;
+
+        std::size_t batch = batch_size(index);
+        if (bin.count > 2 * batch) {
+            release(*pool, bin, index, batch);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
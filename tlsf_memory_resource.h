@@ -0,0 +1,295 @@
+#pragma once
+#include "expandable_memory_resource.h"
+#include <memory_resource>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+class tlsf_memory_resource : public expandable_memory_resource {
+private:
+    struct alignas(std::max_align_t) block_header {
+        block_header* prev_phys;
+        std::size_t size;
+    };
+
+    struct alignas(std::max_align_t) free_links {
+        block_header* next;
+        block_header* prev;
+    };
+
+    struct alignas(std::max_align_t) chunk_header {
+        chunk_header* next;
+        std::size_t size;
+    };
+
+    static constexpr std::size_t align_size = alignof(std::max_align_t);
+    static constexpr std::size_t align_log2 = std::countr_zero(align_size);
+    static constexpr std::size_t sl_log2 = 5;
+    static constexpr std::size_t sl_count = std::size_t(1) << sl_log2;
+    static constexpr std::size_t fl_shift = sl_log2 + align_log2;
+    static constexpr std::size_t small_block_size = std::size_t(1) << fl_shift;
+    static constexpr std::size_t fl_max = sizeof(std::size_t) * 8 - 2;
+    static constexpr std::size_t fl_count = fl_max - fl_shift + 2;
+
+    static constexpr std::size_t round_up(std::size_t n, std::size_t a) {
+        return (n + a - 1) & ~(a - 1);
+    }
+
+    static constexpr std::size_t header_size = sizeof(block_header);
+    static constexpr std::size_t chunk_header_size = sizeof(chunk_header);
+    static constexpr std::size_t min_payload = sizeof(free_links);
+    static constexpr std::size_t min_block = header_size + min_payload;
+    static constexpr std::size_t max_request = std::size_t(1) << fl_max;
+
+    static constexpr std::size_t free_bit = 1;
+    static constexpr std::size_t size_mask = ~(align_size - 1);
+
+    std::pmr::memory_resource* upstream_;
+    std::size_t next_chunk_size_;
+    chunk_header* chunks_ = nullptr;
+
+    std::uint64_t fl_bitmap_ = 0;
+    std::uint32_t sl_bitmap_[fl_count] = {};
+    block_header* blocks_[fl_count][sl_count] = {};
+
+    static std::size_t block_size(const block_header* b) { return b->size & size_mask; }
+    static bool is_free(const block_header* b) { return (b->size & free_bit) != 0; }
+
+    static char* payload(block_header* b) { return reinterpret_cast<char*>(b) + header_size; }
+    static block_header* from_payload(void* p) {
+        return reinterpret_cast<block_header*>(static_cast<char*>(p) - header_size);
+    }
+    static free_links* links(block_header* b) { return reinterpret_cast<free_links*>(payload(b)); }
+    static block_header* next_phys(block_header* b) {
+        return reinterpret_cast<block_header*>(payload(b) + block_size(b));
+    }
+
+    static void mapping(std::size_t size, std::size_t& fl, std::size_t& sl) {
+        if (size < small_block_size) {
+            fl = 0;
+            sl = size / (small_block_size / sl_count);
+        } else {
+            fl = std::bit_width(size) - 1;
+            sl = (size >> (fl - sl_log2)) ^ sl_count;
+            fl -= fl_shift - 1;
+        }
+    }
+
+    static std::size_t round_for_search(std::size_t size) {
+        if (size >= small_block_size) {
+            std::size_t round = (std::size_t(1) << (std::bit_width(size) - 1 - sl_log2)) - 1;
+            size += round;
+        }
+        return size;
+    }
+
+    void insert_free(block_header* b) {
+        std::size_t fl, sl;
+        mapping(block_size(b), fl, sl);
+        block_header* head = blocks_[fl][sl];
+        links(b)->next = head;
+        links(b)->prev = nullptr;
+        if (head) {
+            links(head)->prev = b;
+        }
+        blocks_[fl][sl] = b;
+        fl_bitmap_ |= std::uint64_t(1) << fl;
+        sl_bitmap_[fl] |= std::uint32_t(1) << sl;
+        b->size |= free_bit;
+    }
+
+    void remove_free(block_header* b) {
+        std::size_t fl, sl;
+        mapping(block_size(b), fl, sl);
+        block_header* next = links(b)->next;
+        block_header* prev = links(b)->prev;
+        if (next) {
+            links(next)->prev = prev;
+        }
+        if (prev) {
+            links(prev)->next = next;
+        } else {
+            blocks_[fl][sl] = next;
+            if (!next) {
+                sl_bitmap_[fl] &= ~(std::uint32_t(1) << sl);
+                if (!sl_bitmap_[fl]) {
+                    fl_bitmap_ &= ~(std::uint64_t(1) << fl);
+                }
+            }
+        }
+        b->size &= ~free_bit;
+    }
+
+    block_header* find_suitable(std::size_t size) {
+        std::size_t fl, sl;
+        mapping(round_for_search(size), fl, sl);
+        if (fl >= fl_count) {
+            return nullptr;
+        }
+
+        std::uint32_t sl_map = sl_bitmap_[fl] & (~std::uint32_t(0) << sl);
+        if (!sl_map) {
+            std::uint64_t fl_map = fl + 1 < 64 ? fl_bitmap_ & (~std::uint64_t(0) << (fl + 1)) : 0;
+            if (!fl_map) {
+                return nullptr;
+            }
+            fl = std::countr_zero(fl_map);
+            sl_map = sl_bitmap_[fl];
+        }
+        sl = std::countr_zero(sl_map);
+        return blocks_[fl][sl];
+    }
+
+    block_header* split(block_header* b, std::size_t size) {
+        block_header* rest = reinterpret_cast<block_header*>(payload(b) + size);
+        rest->prev_phys = b;
+        rest->size = block_size(b) - size - header_size;
+        next_phys(rest)->prev_phys = rest;
+        b->size = size | (b->size & free_bit);
+        return rest;
+    }
+
+    block_header* merge_with_next(block_header* b) {
+        block_header* next = next_phys(b);
+        b->size += block_size(next) + header_size;
+        next_phys(b)->prev_phys = b;
+        return b;
+    }
+
+    void add_chunk(std::size_t min_size) {
+        std::size_t overhead = chunk_header_size + 2 * header_size;
+        std::size_t bytes = next_chunk_size_;
+        if (bytes < min_size + overhead) {
+            bytes = round_up(min_size + overhead, align_size);
+        } else if (next_chunk_size_ < max_request / 2) {
+            next_chunk_size_ *= 2;
+        }
+
+        void* memory = upstream_->allocate(bytes, align_size);
+        chunk_header* chunk = static_cast<chunk_header*>(memory);
+        chunk->next = chunks_;
+        chunk->size = bytes;
+        chunks_ = chunk;
+
+        block_header* b = reinterpret_cast<block_header*>(static_cast<char*>(memory) + chunk_header_size);
+        b->prev_phys = nullptr;
+        b->size = bytes - overhead;
+
+        block_header* sentinel = next_phys(b);
+        sentinel->prev_phys = b;
+        sentinel->size = 0;
+
+        insert_free(b);
+    }
+
+public:
+    explicit tlsf_memory_resource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+                                  std::size_t initial_chunk_size = 64 * 1024)
+        : upstream_(upstream), next_chunk_size_(round_up(initial_chunk_size, align_size)) {}
+
+    tlsf_memory_resource(const tlsf_memory_resource&) = delete;
+    tlsf_memory_resource& operator=(const tlsf_memory_resource&) = delete;
+
+    ~tlsf_memory_resource() override {
+        while (chunks_) {
+            chunk_header* next = chunks_->next;
+            upstream_->deallocate(chunks_, chunks_->size, align_size);
+            chunks_ = next;
+        }
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream_; }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        if (bytes > max_request / 2 || alignment > max_request / 4) {
+            throw std::bad_alloc();
+        }
+
+        std::size_t size = round_up(bytes < min_payload ? min_payload : bytes, align_size);
+        std::size_t search_size = alignment > align_size ? size + alignment + min_block : size;
+
+        block_header* b = find_suitable(search_size);
+        if (!b) {
+            add_chunk(round_for_search(search_size));
+            b = find_suitable(search_size);
+        }
+        remove_free(b);
+
+        if (alignment > align_size) {
+            std::uintptr_t base = reinterpret_cast<std::uintptr_t>(payload(b));
+            std::uintptr_t aligned = (base + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+            if (aligned != base && aligned - base < min_block) {
+                aligned = (base + min_block + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+            }
+            if (aligned != base) {
+                block_header* rest = split(b, aligned - base - header_size);
+                insert_free(b);
+                b = rest;
+            }
+        }
+
+        if (block_size(b) >= size + min_block) {
+            insert_free(split(b, size));
+        }
+        return payload(b);
+    }
+
+    void do_deallocate(void* p, std::size_t, std::size_t) override {
+        block_header* b = from_payload(p);
+
+        block_header* next = next_phys(b);
+        if (is_free(next)) {
+            remove_free(next);
+            merge_with_next(b);
+        }
+
+        block_header* prev = b->prev_phys;
+        if (prev && is_free(prev)) {
+            remove_free(prev);
+            b = merge_with_next(prev);
+        }
+
+        insert_free(b);
+    }
+
+    bool do_try_expand(void* p, std::size_t, std::size_t new_bytes) override {
+        if (new_bytes > max_request / 2) {
+            return false;
+        }
+        block_header* b = from_payload(p);
+        std::size_t size = round_up(new_bytes < min_payload ? min_payload : new_bytes, align_size);
+        if (size <= block_size(b)) {
+            if (block_size(b) >= size + min_block) {
+                block_header* rest = split(b, size);
+                block_header* next = next_phys(rest);
+                if (is_free(next)) {
+                    remove_free(next);
+                    merge_with_next(rest);
+                }
+                insert_free(rest);
+            }
+            return true;
+        }
+
+        block_header* next = next_phys(b);
+        if (!is_free(next) || block_size(b) + header_size + block_size(next) < size) {
+            return false;
+        }
+        remove_free(next);
+        merge_with_next(b);
+        if (block_size(b) >= size + min_block) {
+            insert_free(split(b, size));
+        }
+        return true;
+    }
+
+    std::size_t do_good_size(std::size_t bytes, std::size_t) const override {
+        return round_up(bytes < min_payload ? min_payload : bytes, align_size);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
@@ -0,0 +1,251 @@
+#pragma once
+#include "expandable_memory_resource.h"
+#include <memory_resource>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One traced call. For try_expand() records `size` is the requested new
+// size and `flags` tells whether the block grew; for good_size() records
+// `size` and the alignment are the query and `address` is zero.
+struct allocation_trace_record {
+    static constexpr std::uint8_t allocate = 0;
+    static constexpr std::uint8_t deallocate = 1;
+    static constexpr std::uint8_t expand = 2;
+    static constexpr std::uint8_t good_size = 3;
+
+    static constexpr std::uint16_t expanded = 1;
+
+    std::uint64_t timestamp_ns;
+    std::uint64_t address;
+    std::uint64_t size;
+    std::uint32_t thread;
+    std::uint8_t alignment_log2;
+    std::uint8_t kind;
+    std::uint16_t flags;
+
+    std::size_t alignment() const { return std::size_t(1) << alignment_log2; }
+};
+
+static_assert(sizeof(allocation_trace_record) == 32, "Trace records are written to disk as-is");
+
+struct allocation_trace_header {
+    static constexpr std::uint64_t file_magic = 0x4543'4152'5452'4d50ULL;
+    static constexpr std::uint32_t file_version = 2;
+
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t record_size;
+};
+
+// Forwards to upstream and appends one fixed-size record per allocate,
+// deallocate, try_expand() and good_size() to a binary trace file. The
+// extension hooks are forwarded so a traced container makes the same calls
+// it would make untraced. Each thread appends to its own buffer, so the
+// hot path only takes an uncontended lock; a flush locks every buffer at
+// once, merges them by timestamp and writes the batch. Deallocations are
+// logged before the memory goes back upstream, so an address never shows
+// up as reused before it was freed.
+class tracing_memory_resource : public expandable_memory_resource {
+private:
+    static constexpr std::size_t buffer_records = 4096;
+
+    struct thread_buffer {
+        std::thread::id owner;
+        std::mutex lock;
+        std::vector<allocation_trace_record> records;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::uint64_t id;
+    mutable std::ofstream out;
+    // Guards the buffer list, the file and the merge scratch space.
+    mutable std::mutex mutex;
+    mutable std::vector<std::unique_ptr<thread_buffer>> buffers;
+    mutable std::vector<allocation_trace_record> merged;
+    std::chrono::steady_clock::time_point start;
+    mutable std::uint64_t written = 0;
+
+    static std::uint64_t next_id() {
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static std::uint32_t thread_index() {
+        static std::atomic<std::uint32_t> next_index{0};
+        thread_local std::uint32_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    // Ids are never reused, so a cached pointer cannot outlive its tracer
+    // and be picked up by a new one at the same address.
+    thread_buffer& local_buffer() const {
+        struct cache_entry {
+            std::uint64_t tracer = 0;
+            thread_buffer* buffer = nullptr;
+        };
+        thread_local cache_entry cache;
+        if (cache.tracer == id) {
+            return *cache.buffer;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::thread::id self = std::this_thread::get_id();
+        auto it = std::find_if(buffers.begin(), buffers.end(),
+                               [self](const std::unique_ptr<thread_buffer>& b) { return b->owner == self; });
+        if (it == buffers.end()) {
+            auto b = std::make_unique<thread_buffer>();
+            b->owner = self;
+            b->records.reserve(buffer_records);
+            buffers.push_back(std::move(b));
+            it = buffers.end() - 1;
+        }
+        cache = cache_entry{id, it->get()};
+        return **it;
+    }
+
+    // Holding every buffer lock at once makes the batch a consistent cut:
+    // anything recorded after it carries a later timestamp than anything in
+    // it, so batches can be written one after another.
+    void write_pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& b : buffers) {
+            b->lock.lock();
+        }
+        for (auto& b : buffers) {
+            merged.insert(merged.end(), b->records.begin(), b->records.end());
+            b->records.clear();
+        }
+        for (auto& b : buffers) {
+            b->lock.unlock();
+        }
+
+        std::stable_sort(merged.begin(), merged.end(),
+                         [](const allocation_trace_record& a, const allocation_trace_record& b) {
+                             return a.timestamp_ns < b.timestamp_ns;
+                         });
+        out.write(reinterpret_cast<const char*>(merged.data()),
+                  static_cast<std::streamsize>(merged.size() * sizeof(allocation_trace_record)));
+        written += merged.size();
+        merged.clear();
+    }
+
+    void record(std::uint8_t kind, const void* p, std::size_t bytes, std::size_t alignment,
+                std::uint16_t flags = 0) const {
+        std::uint32_t thread = thread_index();
+        thread_buffer& b = local_buffer();
+        std::unique_lock<std::mutex> lock(b.lock);
+        auto now = std::chrono::steady_clock::now();
+        allocation_trace_record r{};
+        r.timestamp_ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+        r.address = reinterpret_cast<std::uintptr_t>(p);
+        r.size = bytes;
+        r.thread = thread;
+        r.alignment_log2 = static_cast<std::uint8_t>(std::countr_zero(alignment));
+        r.kind = kind;
+        r.flags = flags;
+        b.records.push_back(r);
+        bool full = b.records.size() >= buffer_records;
+        lock.unlock();
+        if (full) {
+            write_pending();
+        }
+    }
+
+public:
+    explicit tracing_memory_resource(const std::string& path,
+                                     std::pmr::memory_resource* upstream_mr = std::pmr::get_default_resource())
+        : upstream(upstream_mr), id(next_id()), out(path, std::ios::binary | std::ios::trunc),
+          start(std::chrono::steady_clock::now()) {
+        if (!out) {
+            throw std::runtime_error("Cannot open trace file " + path);
+        }
+        allocation_trace_header header{allocation_trace_header::file_magic, allocation_trace_header::file_version,
+                                       sizeof(allocation_trace_record)};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    tracing_memory_resource(const tracing_memory_resource&) = delete;
+    tracing_memory_resource& operator=(const tracing_memory_resource&) = delete;
+
+    ~tracing_memory_resource() override {
+        flush();
+    }
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream; }
+
+    void flush() {
+        write_pending();
+        std::lock_guard<std::mutex> lock(mutex);
+        out.flush();
+    }
+
+    std::uint64_t records_written() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::uint64_t total = written;
+        for (auto& b : buffers) {
+            std::lock_guard<std::mutex> buffer_lock(b->lock);
+            total += b->records.size();
+        }
+        return total;
+    }
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        void* p = upstream->allocate(bytes, alignment);
+        record(allocation_trace_record::allocate, p, bytes, alignment);
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        record(allocation_trace_record::deallocate, p, bytes, alignment);
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_try_expand(void* p, std::size_t old_bytes, std::size_t new_bytes) override {
+        bool result = ::try_expand(upstream, p, old_bytes, new_bytes);
+        record(allocation_trace_record::expand, p, new_bytes, 1, result ? allocation_trace_record::expanded : 0);
+        return result;
+    }
+
+    std::size_t do_good_size(std::size_t bytes, std::size_t alignment) const override {
+        record(allocation_trace_record::good_size, nullptr, bytes, alignment);
+        return ::good_size(upstream, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+inline std::vector<allocation_trace_record> load_allocation_trace(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open trace file " + path);
+    }
+    allocation_trace_header header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || header.magic != allocation_trace_header::file_magic ||
+        header.version != allocation_trace_header::file_version ||
+        header.record_size != sizeof(allocation_trace_record)) {
+        throw std::runtime_error("File is not an allocation trace: " + path);
+    }
+
+    std::vector<allocation_trace_record> records;
+    allocation_trace_record r;
+    while (in.read(reinterpret_cast<char*>(&r), sizeof(r))) {
+        records.push_back(r);
+    }
+    return records;
+}